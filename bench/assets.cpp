@@ -0,0 +1,84 @@
+#include "assets/loader.h"
+#include "assets/mipmaps.h"
+#include "bench.h"
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <thread>
+
+namespace {
+
+void BM_LoadScene(benchmark::State &state, const std::vector<std::filesystem::path> &models) {
+	const auto workers = static_cast<size_t>(state.range(0));
+
+	std::vector<std::string> paths;
+	for (const auto &model : models)
+		paths.push_back(model.string());
+
+	for (auto _ : state) {
+		assets::Loader loader(workers);
+
+		for (auto &future : loader.load_meshes(paths)) {
+			auto mesh = future.get();
+			benchmark::DoNotOptimize(mesh.vertices.data());
+		}
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * paths.size()));
+}
+
+// Decode + mip generation on a miss against a primed texture cache
+void BM_LoadTexture(benchmark::State &state, const std::string &path, const bool cached) {
+	const auto			directory = std::filesystem::temp_directory_path() / "scop_bench_textures";
+	assets::TextureCache cache(cached ? directory : std::filesystem::path());
+
+	if (cached)
+		assets::Loader(1, cache).load_texture(path).wait();
+
+	for (auto _ : state) {
+		assets::Loader loader(1, cache);
+
+		const auto	  &texture = loader.load_texture(path).get();
+		if (!texture) {
+			state.SkipWithError("couldn't load texture");
+			break;
+		}
+		benchmark::DoNotOptimize(texture.pixels.get());
+	}
+
+	std::error_code ec;
+	std::filesystem::remove_all(directory, ec);
+}
+
+void BM_GenerateMips(benchmark::State &state, const graphics::resources::Texture &texture, const assets::MipFilter filter) {
+	assets::ThreadPool pool(static_cast<size_t>(state.range(0)));
+
+	for (auto _ : state) {
+		auto res = assets::generate_mips(texture, filter, &pool);
+		benchmark::DoNotOptimize(res.pixels.get());
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * texture.device_size()));
+}
+
+} // namespace
+
+void bench::register_assets_benchmarks(const std::vector<std::filesystem::path> &models) {
+	auto *bm = benchmark::RegisterBenchmark("BM_LoadScene", BM_LoadScene, models);
+
+	bm->ArgName("workers")->Unit(benchmark::kMillisecond)->UseRealTime();
+	for (int64_t workers = 1; workers <= std::max<int64_t>(1, std::thread::hardware_concurrency()); workers *= 2)
+		bm->Arg(workers);
+
+	const auto texture = std::filesystem::path(SCOP_RESOURCES_DIR) / "textures" / "viking_room.png";
+	if (std::filesystem::exists(texture)) {
+		benchmark::RegisterBenchmark("BM_LoadTexture/decode", BM_LoadTexture, texture.string(), false)->Unit(benchmark::kMillisecond)->UseRealTime();
+		benchmark::RegisterBenchmark("BM_LoadTexture/cached", BM_LoadTexture, texture.string(), true)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+		const auto decoded = graphics::resources::Texture::load(texture.string());
+		for (const auto &[name, filter] : {std::pair{"box", assets::MipFilter::Box}, std::pair{"kaiser", assets::MipFilter::Kaiser}}) {
+			auto *mips = benchmark::RegisterBenchmark((std::string("BM_GenerateMips/") + name).c_str(), BM_GenerateMips, decoded, filter);
+			mips->ArgName("workers")->Unit(benchmark::kMillisecond)->UseRealTime();
+			for (int64_t workers = 1; workers <= std::max<int64_t>(1, std::thread::hardware_concurrency()); workers *= 2)
+				mips->Arg(workers);
+		}
+	}
+}
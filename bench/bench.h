@@ -0,0 +1,22 @@
+#ifndef SCOP_BENCH_H
+#define SCOP_BENCH_H
+
+#include <filesystem>
+#include <vector>
+
+#ifndef SCOP_RESOURCES_DIR
+#define SCOP_RESOURCES_DIR "resources"
+#endif
+
+namespace bench {
+
+// Every `.obj` under SCOP_RESOURCES_DIR, sorted so that benchmark names and ordering are stable across runs.
+std::vector<std::filesystem::path> resource_models();
+
+void							   register_parser_benchmarks(const std::vector<std::filesystem::path> &models);
+void							   register_geometry_benchmarks(const std::vector<std::filesystem::path> &models);
+void							   register_assets_benchmarks(const std::vector<std::filesystem::path> &models);
+
+} // namespace bench
+
+#endif // SCOP_BENCH_H
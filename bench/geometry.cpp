@@ -0,0 +1,116 @@
+#include "bench.h"
+#include "geometry/bvh.h"
+#include "geometry/mesh.h"
+#include "maths/utils.h"
+#include "parser/parser.h"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cmath>
+
+namespace {
+
+void BM_BuildMesh(benchmark::State &state, const std::filesystem::path &model) {
+	const auto file	 = parser::parse(model.string());
+	const auto faces = std::distance(file.begin(), file.end());
+
+	for (auto _ : state) {
+		auto mesh = geometry::build_mesh(file);
+		benchmark::DoNotOptimize(mesh.vertices.data());
+		benchmark::DoNotOptimize(mesh.indices.data());
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * faces));
+	state.counters["faces"] = static_cast<double>(faces);
+}
+
+// Unit boxes on a cubic grid two units apart, as many as the benchmark's argument
+std::vector<geometry::Aabb> grid_boxes(const int64_t count) {
+	const auto					side = static_cast<int64_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+	std::vector<geometry::Aabb> boxes;
+
+	boxes.reserve(count);
+	for (int64_t i = 0; i < count; i++) {
+		const maths::Vec3 corner(static_cast<float>(i % side) * 2, static_cast<float>(i / side % side) * 2, static_cast<float>(i / side / side) * 2);
+		geometry::Aabb	  box;
+		box.grow(corner);
+		box.grow(corner + maths::Vec3(1, 1, 1));
+		boxes.push_back(box);
+	}
+	return boxes;
+}
+
+void BM_BvhBuild(benchmark::State &state) {
+	const auto boxes = grid_boxes(state.range(0));
+
+	for (auto _ : state) {
+		geometry::Bvh bvh(boxes);
+		benchmark::DoNotOptimize(&bvh);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// From a corner of the grid looking at its center, so that part of it is in view, part beside and part behind
+void BM_BvhCull(benchmark::State &state) {
+	const auto			  boxes = grid_boxes(state.range(0));
+	const geometry::Bvh	  bvh(boxes);
+	const float			  side = std::cbrt(static_cast<float>(state.range(0))) * 2;
+	const auto			  view = maths::Mat4::lookAt(maths::Vec3(side * 0.25f, side * 0.25f, side * 0.25f), maths::Vec3(side, side * 0.5f, side * 0.5f), maths::Vec3(0, 0, 1));
+	const geometry::Frustum frustum(view * maths::Mat4::perspective(maths::rad(45), 16.0f / 9, 0.1f, side));
+	std::vector<uint32_t> visible;
+
+	visible.reserve(boxes.size());
+	for (auto _ : state) {
+		visible.clear();
+		bvh.cull(frustum, visible);
+		benchmark::DoNotOptimize(visible.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.counters["visible"] = static_cast<double>(visible.size());
+}
+
+// A hundredth of the boxes jump across the grid and back every iteration, refitted rather than rebuilt, then the same
+// cull as BM_BvhCull. Fails when the culled set differs from testing every box on its own.
+void BM_BvhRefit(benchmark::State &state) {
+	const auto				boxes = grid_boxes(state.range(0));
+	geometry::Bvh			bvh(boxes);
+	const float				side = std::cbrt(static_cast<float>(state.range(0))) * 2;
+	const auto				view = maths::Mat4::lookAt(maths::Vec3(side * 0.25f, side * 0.25f, side * 0.25f), maths::Vec3(side, side * 0.5f, side * 0.5f), maths::Vec3(0, 0, 1));
+	const geometry::Frustum frustum(view * maths::Mat4::perspective(maths::rad(45), 16.0f / 9, 0.1f, side));
+	std::vector<uint32_t>	visible;
+	bool					away = false;
+
+	visible.reserve(boxes.size());
+	for (auto _ : state) {
+		away = !away;
+		for (size_t item = 0; item < boxes.size(); item += 100)
+			bvh.refit(static_cast<uint32_t>(item), away ? boxes[boxes.size() - 1 - item] : boxes[item]);
+		visible.clear();
+		bvh.cull(frustum, visible);
+		benchmark::DoNotOptimize(visible.data());
+	}
+
+	std::vector<uint32_t> expected;
+	for (uint32_t item = 0; item < bvh.size(); item++) {
+		if (frustum.test(bvh.bounds(item)) != geometry::Frustum::Test::OUTSIDE)
+			expected.push_back(item);
+	}
+	std::ranges::sort(visible);
+	if (visible != expected)
+		state.SkipWithError("refitted tree culls differently from the boxes it holds");
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.counters["moved"]	  = static_cast<double>((boxes.size() + 99) / 100);
+	state.counters["visible"] = static_cast<double>(visible.size());
+}
+
+} // namespace
+
+void bench::register_geometry_benchmarks(const std::vector<std::filesystem::path> &models) {
+	for (const auto &model : models) {
+		const auto name = "BM_BuildMesh/" + std::filesystem::relative(model, SCOP_RESOURCES_DIR).string();
+		benchmark::RegisterBenchmark(name.c_str(), BM_BuildMesh, model)->Unit(benchmark::kMicrosecond);
+	}
+	benchmark::RegisterBenchmark("BM_BvhBuild", BM_BvhBuild)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("BM_BvhCull", BM_BvhCull)->Arg(1000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+	benchmark::RegisterBenchmark("BM_BvhRefit", BM_BvhRefit)->Arg(1000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+}
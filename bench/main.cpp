@@ -0,0 +1,42 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+
+#ifndef SCOP_GIT_REVISION
+#define SCOP_GIT_REVISION "unknown"
+#endif
+
+namespace bench {
+
+std::vector<std::filesystem::path> resource_models() {
+	std::vector<std::filesystem::path> models;
+
+	for (const auto &entry : std::filesystem::recursive_directory_iterator(SCOP_RESOURCES_DIR)) {
+		if (entry.is_regular_file() && entry.path().extension() == ".obj")
+			models.push_back(entry.path());
+	}
+	std::ranges::sort(models);
+
+	return models;
+}
+
+} // namespace bench
+
+int main(int ac, char **av) {
+	const auto models = bench::resource_models();
+
+	bench::register_parser_benchmarks(models);
+	bench::register_geometry_benchmarks(models);
+	bench::register_assets_benchmarks(models);
+
+	benchmark::Initialize(&ac, av);
+	if (benchmark::ReportUnrecognizedArguments(ac, av))
+		return 1;
+
+	benchmark::AddCustomContext("scop_revision", SCOP_GIT_REVISION);
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	return 0;
+}
@@ -0,0 +1,93 @@
+#include "maths/mat.h"
+#include "maths/vec.h"
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Fixed seed: every run (and every commit) benchmarks the exact same inputs.
+constexpr std::mt19937::result_type SEED	   = 0x5c09;
+constexpr size_t					INPUT_SIZE = 1024;
+
+std::vector<maths::Mat4> random_matrices() {
+	std::mt19937						  rng(SEED);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	std::vector<maths::Mat4>			  res;
+
+	res.reserve(INPUT_SIZE);
+	for (size_t i = 0; i < INPUT_SIZE; i++) {
+		maths::Mat4 m;
+		for (size_t l = 0; l < 4; l++)
+			for (size_t c = 0; c < 4; c++)
+				m[l][c] = dist(rng);
+		res.push_back(m);
+	}
+	return res;
+}
+
+std::vector<maths::Vec3> random_vectors() {
+	std::mt19937						  rng(SEED);
+	std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+	std::vector<maths::Vec3>			  res;
+
+	res.reserve(INPUT_SIZE);
+	for (size_t i = 0; i < INPUT_SIZE; i++)
+		res.emplace_back(dist(rng), dist(rng), dist(rng));
+	return res;
+}
+
+void BM_Mat4Multiply(benchmark::State &state) {
+	const auto matrices = random_matrices();
+	size_t	   i		= 0;
+
+	for (auto _ : state) {
+		auto res = matrices[i % INPUT_SIZE] * matrices[(i + 1) % INPUT_SIZE];
+		benchmark::DoNotOptimize(res);
+		i++;
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_Mat4Multiply);
+
+void BM_Mat4MultiplyChain(benchmark::State &state) {
+	// proj * view * model, as done for every frame's UBO
+	const auto matrices = random_matrices();
+	size_t	   i		= 0;
+
+	for (auto _ : state) {
+		auto res = matrices[i % INPUT_SIZE] * matrices[(i + 1) % INPUT_SIZE] * matrices[(i + 2) % INPUT_SIZE];
+		benchmark::DoNotOptimize(res);
+		i++;
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_Mat4MultiplyChain);
+
+void BM_Vec3Normalize(benchmark::State &state) {
+	const auto vectors = random_vectors();
+	size_t	   i	   = 0;
+
+	for (auto _ : state) {
+		auto res = vectors[i % INPUT_SIZE].normalized();
+		benchmark::DoNotOptimize(res);
+		i++;
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_Vec3Normalize);
+
+void BM_Vec3NormalizeSame(benchmark::State &state) {
+	// Hits Vec3's cached norm on every iteration, to compare against BM_Vec3Normalize
+	const maths::Vec3 v(1.0f, 2.0f, 3.0f);
+
+	for (auto _ : state) {
+		auto res = v.normalized();
+		benchmark::DoNotOptimize(res);
+	}
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_Vec3NormalizeSame);
+
+} // namespace
@@ -0,0 +1,60 @@
+#include "bench.h"
+#include "parser/parser.h"
+#include "parser/utils.h"
+
+#include <array>
+#include <benchmark/benchmark.h>
+#include <string_view>
+
+namespace {
+
+using namespace std::string_view_literals;
+
+constexpr std::array SPLIT_LINES{
+	"v 1.368074 1.109826 -0.227403"sv,
+	"vt 0.625000 0.500000"sv,
+	"vn -0.000000 1.000000 -0.000000"sv,
+	"f 5/1/1 3/2/1 1/3/1 7/4/1"sv,
+};
+
+void BM_Split(benchmark::State &state) {
+	const auto line = SPLIT_LINES[state.range(0)];
+
+	for (auto _ : state) {
+		std::vector<std::string> args;
+		parser::split(args, line);
+		benchmark::DoNotOptimize(args.data());
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * line.size()));
+}
+BENCHMARK(BM_Split)->DenseRange(0, SPLIT_LINES.size() - 1);
+
+void BM_SplitIndices(benchmark::State &state) {
+	constexpr auto arg = "4675/4675/2868"sv;
+
+	for (auto _ : state) {
+		std::vector<std::string> values;
+		parser::split(values, arg, "/"sv);
+		benchmark::DoNotOptimize(values.data());
+	}
+}
+BENCHMARK(BM_SplitIndices);
+
+void BM_Parse(benchmark::State &state, const std::filesystem::path &model) {
+	const auto bytes = std::filesystem::file_size(model);
+
+	for (auto _ : state) {
+		auto file = parser::parse(model.string());
+		benchmark::DoNotOptimize(file.begin());
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+
+} // namespace
+
+void bench::register_parser_benchmarks(const std::vector<std::filesystem::path> &models) {
+	for (const auto &model : models) {
+		const auto name = "BM_Parse/" + std::filesystem::relative(model, SCOP_RESOURCES_DIR).string();
+		benchmark::RegisterBenchmark(name.c_str(), BM_Parse, model)->Unit(benchmark::kMicrosecond);
+	}
+}
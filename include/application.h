@@ -1,10 +1,18 @@
 #ifndef SCOP_APPLICATION_H
 #define SCOP_APPLICATION_H
 
+#include "assets/loader.h"
+#include "geometry/mesh.h"
 #include "graphics/vulkan.h"
 
+#include <array>
+#include <future>
 #include <GLFW/glfw3.h>
 #include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
 #include <vulkan/vulkan.h>
 
 #ifndef DEBUG
@@ -16,7 +24,6 @@ constexpr uint32_t APPLICATION_VERSION		= VK_MAKE_VERSION(1, 0, 0);
 constexpr uint32_t WINDOW_WIDTH				= 800;
 constexpr uint32_t WINDOW_HEIGHT			= 600;
 constexpr bool	   ENABLE_VALIDATION_LAYERS = DEBUG;
-constexpr uint32_t MAX_FRAMES_IN_FLIGHT		= 2;
 
 class Application {
 public:
@@ -24,21 +31,65 @@ public:
 	~Application();
 
 private:
-	void init();
-	void init_window();
+	struct Options {
+		std::optional<assets::MipFilter> mipFilter	   = assets::MipFilter::Box;
+		size_t							 textureBudget = size_t{256} << 20;
+		// Frame timings written there on exit, as JSON for a .json extension and CSV otherwise
+		std::optional<std::string>		 profileOutput;
+		// Renders offscreen without a window and writes the last frame to this PNG
+		std::optional<std::string>		 headlessOutput;
+		uint32_t						 frames = 1;
+		VkExtent2D						 size{WINDOW_WIDTH, WINDOW_HEIGHT};
+		bool							 recordOnce = false;
+		// Copies of every model drawn along x, y and z, as instances of a single object
+		std::array<uint32_t, 3>			 grid{1, 1, 1};
+		bool							 gpuDriven = false;
+		// Also skips instances hidden behind what was drawn last frame, tested against a depth pyramid
+		bool							 occlusionCulling = false;
+		uint32_t						 framesInFlight = graphics::DEFAULT_FRAMES_IN_FLIGHT;
+		// Left to the swapchain's defaults when unset
+		std::optional<uint32_t>			 swapchainImages;
+		std::optional<VkPresentModeKHR>	 presentMode;
+		graphics::FramePacing			 pacing = graphics::FramePacing::THROUGHPUT;
+		std::vector<std::string>		 models;
+	};
+
+	// Exits with the usage on invalid arguments
+	static Options parse_options(int ac, char **av);
+	explicit	   Application(const Options &options);
+
+	void		   init();
+	void		   init_window();
+	// Every model as one object of the scene mesh
+	std::pair<geometry::Mesh, std::vector<graphics::SceneObject>> collect_geometry();
+	// Placements of the copies of a model on the grid of the options, the identity alone without one
+	std::vector<maths::Mat4>									 grid_instances(std::span<const geometry::Vertex> vertices) const;
+	// Resolves each material's diffuse map into a deduplicated texture list, returned with the material -> texture mapping,
+	// materials without a usable map mapping to none
+	std::pair<std::vector<graphics::resources::Texture>, std::vector<std::optional<uint32_t>>> collect_textures(const geometry::Mesh &scene);
 
 public:
 	int	 run() const;
+	int	 run_headless() const;
 	void mark_framebuffer_resized() const;
 
 private:
+	void	 write_profile() const;
 	void	 select_physical_device();
 	uint32_t check_physical_device_suitability(VkPhysicalDevice physicalDevice) const;
 	bool check_mandatory_features(VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties deviceProperties, VkPhysicalDeviceFeatures deviceFeatures) const;
 
-	std::shared_ptr<GLFWwindow>				  _window;
-	std::unique_ptr<graphics::VulkanInstance> _instance;
-	VkPhysicalDevice						  _physicalDevice;
+	Options															 _options;
+	assets::Loader													 _loader;
+	std::vector<std::pair<std::string, std::future<geometry::Mesh>>> _meshes;
+	std::future<std::shared_ptr<graphics::resources::Shader>>		 _vertexShader;
+	std::future<std::shared_ptr<graphics::resources::Shader>>		 _fragmentShader;
+	std::future<std::shared_ptr<graphics::resources::Shader>>		 _cullShader;
+	std::future<std::shared_ptr<graphics::resources::Shader>>		 _pyramidShader;
+
+	std::shared_ptr<GLFWwindow>										 _window;
+	std::unique_ptr<graphics::VulkanInstance>						 _instance;
+	VkPhysicalDevice												 _physicalDevice;
 
 public:
 				 Application()					  = delete;
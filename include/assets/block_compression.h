@@ -0,0 +1,17 @@
+#ifndef SCOP_ASSETS_BLOCK_COMPRESSION_H
+#define SCOP_ASSETS_BLOCK_COMPRESSION_H
+
+#include "assets/thread_pool.h"
+#include "graphics/textures.h"
+
+// CPU encoders for the block-compressed texture formats, meant for offline conversion rather than load time.
+namespace assets::bc {
+
+// Encodes every mip level of an RGBA8 texture into `format`. Rows of blocks are spread over `pool` when given.
+// BC1 picks its endpoints along the principal axis of each block; BC7 only uses mode 6 (one subset, RGBA endpoints),
+// refined once by least squares, which trades some quality on multi-colored blocks for a simple and fast encoder.
+graphics::resources::Texture compress(const graphics::resources::Texture &source, graphics::resources::Texture::Format format, ThreadPool *pool = nullptr);
+
+} // namespace assets::bc
+
+#endif // SCOP_ASSETS_BLOCK_COMPRESSION_H
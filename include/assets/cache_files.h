@@ -0,0 +1,27 @@
+#ifndef SCOP_ASSETS_CACHE_FILES_H
+#define SCOP_ASSETS_CACHE_FILES_H
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string_view>
+
+// What the on-disk caches (textures, SPIR-V, pipelines) share: where they live and how their files are written.
+// Failures are reported as warnings and never thrown, a cache that can't be written is only slower.
+namespace assets::cache_files {
+
+// $XDG_CACHE_HOME/scop/<name>, or ~/.cache/scop/<name>, empty when neither is set
+std::filesystem::path default_directory(std::string_view name);
+
+// Creates the parent directory, writes `contents` aside then renames it to `path`, so that concurrent runs never read a
+// half written file. `what` names the file in warnings. Returns whether `path` was written.
+bool				  write(const std::filesystem::path &path, std::string_view what, const std::function<void(std::ostream &)> &contents);
+
+// Bytes between the read position and the end, to check sizes read from a file against before allocating them
+uint64_t			  remaining(std::istream &is);
+
+} // namespace assets::cache_files
+
+#endif // SCOP_ASSETS_CACHE_FILES_H
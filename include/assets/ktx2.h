@@ -0,0 +1,18 @@
+#ifndef SCOP_ASSETS_KTX2_H
+#define SCOP_ASSETS_KTX2_H
+
+#include "graphics/textures.h"
+
+#include <string>
+
+// Minimal KTX 2.0 container support: single 2D image with its mip levels, no supercompression.
+// Only the formats representable by graphics::resources::Texture::Format are accepted.
+namespace assets::ktx2 {
+
+// Throws std::runtime_error when the file can't be read or uses unsupported features.
+graphics::resources::Texture read(const std::string &path);
+void						 write(const std::string &path, const graphics::resources::Texture &texture);
+
+} // namespace assets::ktx2
+
+#endif // SCOP_ASSETS_KTX2_H
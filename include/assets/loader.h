@@ -0,0 +1,54 @@
+#ifndef SCOP_ASSETS_LOADER_H
+#define SCOP_ASSETS_LOADER_H
+
+#include "assets/mipmaps.h"
+#include "assets/texture_cache.h"
+#include "assets/thread_pool.h"
+#include "geometry/mesh.h"
+#include "graphics/textures.h"
+
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace assets {
+
+// Parses models and decodes textures on a shared thread pool.
+// Every call returns immediately; results (or the exception raised while loading) are retrieved through the returned future.
+class Loader {
+public:
+	// Decoded textures get their mip chain built on the workers with `mipFilter`; without one they come back with a single
+	// level and the renderer generates the rest on the GPU.
+	explicit Loader(size_t workers = std::thread::hardware_concurrency(), TextureCache cache = TextureCache(),
+					std::optional<MipFilter> mipFilter = MipFilter::Box);
+
+	// Also parses the model's material libraries and starts decoding their diffuse maps right away.
+	std::future<geometry::Mesh>							 load_mesh(const std::string &path);
+	std::vector<std::future<geometry::Mesh>>			 load_meshes(const std::vector<std::string> &paths);
+
+	// Textures are deduplicated on their canonical path: requesting the same file twice decodes it once.
+	// They are read from the texture cache when possible and written to it otherwise.
+	// With `allowCompressed`, an up to date `<name>.ktx2` next to the file (see scop_texconv) is used instead of it.
+	std::shared_future<graphics::resources::Texture>	 load_texture(const std::string &path, bool allowCompressed = true);
+
+private:
+	TextureCache										 _cache;
+	std::optional<MipFilter>							 _mipFilter;
+
+	std::mutex											 _texturesMutex;
+	std::unordered_map<std::string, std::shared_future<graphics::resources::Texture>> _textures;
+
+	// Last, so that it is destroyed (and its pending tasks drained) before anything those tasks use
+	ThreadPool											 _pool;
+
+public:
+			Loader(const Loader &)	= delete;
+	Loader &operator=(const Loader &) = delete;
+};
+
+} // namespace assets
+
+#endif // SCOP_ASSETS_LOADER_H
@@ -0,0 +1,23 @@
+#ifndef SCOP_ASSETS_MIPMAPS_H
+#define SCOP_ASSETS_MIPMAPS_H
+
+#include "assets/thread_pool.h"
+#include "graphics/textures.h"
+
+namespace assets {
+
+enum class MipFilter {
+	// 2x2 average: cheap, slightly blurry
+	Box,
+	// Kaiser-windowed sinc over 8x8 source texels: sharper minification, a bit slower
+	Kaiser,
+};
+
+// Builds the whole mip chain of an RGBA8 sRGB texture on the CPU, each level filtered from the previous one.
+// Color channels are filtered in linear space (alpha as is) with 4-wide vector arithmetic, and the rows of each level are
+// spread over `pool` when given. The result has exactly the layout uploaded by a single vkCmdCopyBufferToImage.
+graphics::resources::Texture generate_mips(const graphics::resources::Texture &source, MipFilter filter = MipFilter::Box, ThreadPool *pool = nullptr);
+
+} // namespace assets
+
+#endif // SCOP_ASSETS_MIPMAPS_H
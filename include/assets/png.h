@@ -0,0 +1,20 @@
+#ifndef SCOP_ASSETS_PNG_H
+#define SCOP_ASSETS_PNG_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// 8-bit RGBA PNG output on top of libpng, for renders and thumbnails
+namespace assets::png {
+
+// `rgba` holds `width * height` pixels, rows top to bottom
+std::vector<uint8_t> encode(uint32_t width, uint32_t height, std::span<const uint8_t> rgba);
+
+// Throws std::runtime_error when the file can't be written
+void				 write(const std::string &path, uint32_t width, uint32_t height, std::span<const uint8_t> rgba);
+
+} // namespace assets::png
+
+#endif // SCOP_ASSETS_PNG_H
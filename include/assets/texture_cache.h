@@ -0,0 +1,36 @@
+#ifndef SCOP_ASSETS_TEXTURE_CACHE_H
+#define SCOP_ASSETS_TEXTURE_CACHE_H
+
+#include "graphics/textures.h"
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace assets {
+
+// On-disk store of decoded textures, mip chain included, in the exact layout uploaded to the GPU.
+// Entries are keyed on the source's canonical path, size and modification time, so editing a texture invalidates it,
+// plus a caller defined `variant` telling apart different processings of the same source (e.g. the mip filter);
+// a missing, stale or corrupted entry is only a miss. Failing to write an entry is reported but never fatal.
+class TextureCache {
+public:
+	// An empty directory disables the cache.
+	explicit												TextureCache(std::filesystem::path directory = default_directory());
+
+	[[nodiscard]] std::optional<graphics::resources::Texture> find(const std::string &path, const std::string &variant) const;
+	void													store(const std::string &path, const std::string &variant, const graphics::resources::Texture &texture) const;
+
+	[[nodiscard]] bool										enabled() const;
+	[[nodiscard]] const std::filesystem::path			   &directory() const;
+
+	// $XDG_CACHE_HOME/scop/textures, or ~/.cache/scop/textures
+	static std::filesystem::path							default_directory();
+
+private:
+	std::filesystem::path									_directory;
+};
+
+} // namespace assets
+
+#endif // SCOP_ASSETS_TEXTURE_CACHE_H
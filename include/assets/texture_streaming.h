@@ -0,0 +1,83 @@
+#ifndef SCOP_ASSETS_TEXTURE_STREAMING_H
+#define SCOP_ASSETS_TEXTURE_STREAMING_H
+
+#include "graphics/textures.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace assets {
+
+// Decides which mip levels of each texture live on the GPU; pure bookkeeping, the renderer carries out the plans.
+//
+// A texture is allocated from its `base` level down to the last one, and sampled from its `resident` level, the largest
+// one uploaded so far (the sampler's minLod being clamped to it). Its mip tail, every level at most `tailSize` texels
+// wide, is always allocated and uploaded up front. Larger levels are requested according to the texture's on-screen
+// size and uploaded smallest first within a per-frame byte budget. When allocations would exceed the memory budget,
+// the top levels of the off-screen or smallest on-screen textures are evicted first.
+class TextureStreamer {
+public:
+	struct Config {
+		size_t memoryBudget = size_t{256} << 20;
+		size_t uploadBudget = size_t{16} << 20; // per frame, at least one level is always uploaded
+		size_t tailSize		= 128;
+	};
+
+	// Reallocate `texture` starting at level `base`, carrying over its levels from `keptFrom` on
+	struct Reallocation {
+		uint32_t texture;
+		uint32_t previousBase;
+		uint32_t base;
+		uint32_t keptFrom;
+	};
+
+	struct Upload {
+		uint32_t texture;
+		uint32_t level;
+	};
+
+	// Reallocations must be applied before the uploads, which must be applied in order
+	struct Plan {
+		std::vector<Reallocation> reallocations;
+		std::vector<Upload>		  uploads;
+	};
+
+								TextureStreamer();
+	explicit					TextureStreamer(Config config);
+
+	// Returns the texture's index. Single level textures are never streamed.
+	uint32_t					add(const graphics::resources::Texture &texture);
+
+	// Footprint of the texture in pixels for the frame being prepared, 0 when it is off-screen
+	void						set_screen_size(uint32_t texture, float screenSize);
+
+	// Assumes the returned plan gets executed
+	Plan						update();
+
+	[[nodiscard]] uint32_t		base(uint32_t texture) const;
+	[[nodiscard]] uint32_t		resident(uint32_t texture) const;
+	[[nodiscard]] uint32_t		tail(uint32_t texture) const;
+	[[nodiscard]] size_t		allocated_bytes() const;
+	[[nodiscard]] size_t		size() const;
+	[[nodiscard]] const Config &config() const;
+
+private:
+	struct Entry {
+		std::vector<size_t> levelSizes;
+		size_t				extent;
+		uint32_t			tail;
+		uint32_t			base;
+		uint32_t			resident;
+		float				screenSize;
+	};
+
+	[[nodiscard]] static size_t	  allocation_size(const Entry &entry, uint32_t base);
+	[[nodiscard]] static uint32_t wanted_level(const Entry &entry);
+
+	Config						  _config;
+	std::vector<Entry>			  _entries;
+};
+
+} // namespace assets
+
+#endif // SCOP_ASSETS_TEXTURE_STREAMING_H
@@ -0,0 +1,59 @@
+#ifndef SCOP_ASSETS_THREAD_POOL_H
+#define SCOP_ASSETS_THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace assets {
+
+class ThreadPool {
+public:
+	explicit ThreadPool(size_t workers = std::thread::hardware_concurrency());
+	~		 ThreadPool();
+
+	template <typename F>
+	auto submit(F &&task) -> std::future<std::invoke_result_t<F>> {
+		using Result = std::invoke_result_t<F>;
+
+		auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+		auto future	  = packaged->get_future();
+		{
+			std::lock_guard lock(_mutex);
+			_tasks.emplace([packaged] { (*packaged)(); });
+		}
+		_cv.notify_one();
+
+		return future;
+	}
+
+	// Runs `body(i)` for every i in [0, count) on the workers and the calling thread, returning once all are done.
+	// The caller keeps claiming indices itself, so this is safe to call from inside a task of the same pool.
+	// The first exception thrown by `body` is rethrown here.
+	void				 parallel_for(size_t count, const std::function<void(size_t)> &body);
+
+	[[nodiscard]] size_t size() const;
+
+private:
+	void							  work();
+
+	std::vector<std::thread>		  _workers;
+	std::queue<std::function<void()>> _tasks;
+	std::mutex						  _mutex;
+	std::condition_variable			  _cv;
+	bool							  _stopping{false};
+
+public:
+				ThreadPool(const ThreadPool &)	 = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+};
+
+} // namespace assets
+
+#endif // SCOP_ASSETS_THREAD_POOL_H
@@ -0,0 +1,106 @@
+#ifndef SCOP_GEOMETRY_BVH_H
+#define SCOP_GEOMETRY_BVH_H
+
+#include "maths/mat.h"
+#include "maths/vec.h"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace geometry {
+
+// Axis aligned box, empty until something is grown into it
+struct Aabb {
+	static constexpr float INF = std::numeric_limits<float>::infinity();
+
+	std::array<float, 3>   min{INF, INF, INF};
+	std::array<float, 3>   max{-INF, -INF, -INF};
+
+	void				   grow(const maths::Vec3 &p);
+	void				   grow(const Aabb &other);
+
+	[[nodiscard]] bool	   empty() const;
+	[[nodiscard]] float	   surface_area() const;
+	[[nodiscard]] float	   centroid(size_t axis) const;
+	// Box around this one once transformed by `m`
+	[[nodiscard]] Aabb	   transformed(const maths::Mat4 &m) const;
+
+	bool				   operator==(const Aabb &) const = default;
+};
+
+// Half-spaces a view-projection matrix keeps, their normals pointing inwards. The near plane is taken at -w, which keeps
+// a little more than Vulkan's clip space does with OpenGL style projections and exactly as much with the others.
+class Frustum {
+public:
+	explicit Frustum(const maths::Mat4 &viewProj);
+
+	enum class Test : uint8_t {
+		OUTSIDE,
+		INTERSECTS,
+		INSIDE,
+	};
+	// Every plane whose bit is set in `planes` is tested, and those `box` is entirely inside of cleared: they need no
+	// testing for anything `box` contains
+	static constexpr uint8_t ALL_PLANES = 0x3f;
+	[[nodiscard]] Test		 test(const Aabb &box, uint8_t &planes) const;
+	[[nodiscard]] Test		 test(const Aabb &box) const;
+
+	// Each as (a, b, c, d), p being inside when a * p.x + b * p.y + c * p.z + d >= 0
+	[[nodiscard]] const std::array<std::array<float, 4>, 6> &planes() const;
+
+private:
+	std::array<std::array<float, 4>, 6> _planes{};
+};
+
+// Bounding volume hierarchy over boxes identified by their index, split where the surface area heuristic says tests are
+// cheapest. Items of a node are contiguous, so a node entirely inside the frustum is taken as a whole without going down.
+class Bvh {
+public:
+							  Bvh() = default;
+	explicit				  Bvh(std::span<const Aabb> boxes);
+
+	// Moves `item` to `box`, refitting only the nodes above it: the tree is not rebuilt, so splits degrade if items move far
+	void					  refit(uint32_t item, const Aabb &box);
+
+	// At least `parts` nodes, when there are enough of them, whose subtrees hold every item once: each can be culled on a
+	// thread of its own
+	[[nodiscard]] auto		  split(size_t parts) const -> std::vector<uint32_t>;
+	// Appends the items of `node`'s subtree not outside `frustum`, in no particular order
+	void					  cull(const Frustum &frustum, std::vector<uint32_t> &visible, uint32_t node = 0) const;
+
+	[[nodiscard]] size_t	  size() const;
+	[[nodiscard]] const Aabb &bounds(uint32_t item) const;
+
+private:
+	static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+	// Children are `left` and `left + 1`, leaves have none
+	struct Node {
+		Aabb	 box;
+		uint32_t first;
+		uint32_t count;
+		uint32_t left;
+		uint32_t parent;
+
+		[[nodiscard]] bool leaf() const {
+			return left == NONE;
+		}
+	};
+
+	void				  build();
+	void				  fit(Node &node) const;
+
+	std::vector<Aabb>	  _boxes;
+	std::vector<Node>	  _nodes;
+	// Item indices, ordered so that each node's are [first, first + count)
+	std::vector<uint32_t> _items;
+	// Leaf of each item
+	std::vector<uint32_t> _leaves;
+};
+
+} // namespace geometry
+
+#endif // SCOP_GEOMETRY_BVH_H
@@ -0,0 +1,61 @@
+#ifndef SCOP_GEOMETRY_MESH_H
+#define SCOP_GEOMETRY_MESH_H
+
+#include "maths/vec.h"
+#include "parser/material.h"
+#include "parser/parser.h"
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+namespace geometry {
+
+struct Vertex {
+	bool operator==(const Vertex &rhs) const {
+		return std::tie(position, color, tex) == std::tie(rhs.position, rhs.color, rhs.tex);
+	}
+
+	bool operator!=(const Vertex &rhs) const {
+		return !(*this == rhs);
+	}
+
+	maths::Vec3 position;
+	maths::Vec3 color;
+	maths::Vec2 tex;
+};
+
+// Contiguous range of `Mesh::indices` drawn with a single material
+struct Submesh {
+	uint32_t material;
+	uint32_t first_index;
+	uint32_t index_count;
+};
+
+struct Mesh {
+	typedef uint32_t			  index_type;
+
+	// Appends `other`, rebasing its indices, materials and submeshes after the ones already present.
+	void						  append(const Mesh &other);
+
+	std::vector<Vertex>			  vertices;
+	std::vector<index_type>		  indices;
+	std::vector<parser::Material> materials;
+	std::vector<Submesh>		  submeshes;
+};
+
+// Flattens the triangulated faces of `file` into a vertex/index pair, deduplicating identical vertices.
+// Triangles are grouped by material so that each material maps to exactly one submesh; materials named by `usemtl`
+// are looked up in `library`, falling back to a default white material when missing.
+Mesh build_mesh(const parser::File &file, const std::vector<parser::Material> &library = {});
+
+} // namespace geometry
+
+template <>
+struct std::hash<geometry::Vertex> {
+	std::size_t operator()(const geometry::Vertex &vertex) const noexcept {
+		return std::hash<maths::Vec3>{}(vertex.position) ^ std::hash<maths::Vec3>{}(vertex.color) ^ std::hash<maths::Vec2>{}(vertex.tex);
+	}
+};
+
+#endif // SCOP_GEOMETRY_MESH_H
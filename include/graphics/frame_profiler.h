@@ -0,0 +1,87 @@
+#ifndef SCOP_FRAME_PROFILER_H
+#define SCOP_FRAME_PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <ostream>
+#include <string_view>
+
+namespace graphics {
+
+// Per-frame timings over a rolling window of frames: CPU scopes timed around the steps of a frame, and GPU passes whose
+// timestamps are only read back once the frame's fence has been waited on, a few frames later. Frames are numbered by
+// begin_frame, late samples being attributed with that number; those older than the window are dropped.
+class FrameProfiler {
+public:
+	enum class Scope : uint8_t {
+		FRAME, // from one begin_frame to the next
+		FENCE_WAIT,
+		ACQUIRE,
+		RECORD,
+		CULL, // within RECORD
+		SUBMIT,
+		PRESENT,
+		GPU_UPLOAD,
+		GPU_RENDER_PASS,
+	};
+	static constexpr size_t SCOPE_COUNT = static_cast<size_t>(Scope::GPU_RENDER_PASS) + 1;
+
+	struct Percentiles {
+		double p50;
+		double p95;
+		double p99;
+	};
+
+	// Times its scope of the current frame, from construction to destruction
+	class Timer {
+	public:
+		Timer(FrameProfiler &profiler, Scope scope);
+		~Timer();
+
+		Timer(const Timer &)			= delete;
+		Timer &operator=(const Timer &) = delete;
+
+	private:
+		FrameProfiler						 &_profiler;
+		Scope								  _scope;
+		uint64_t							  _frame;
+		std::chrono::steady_clock::time_point _start;
+	};
+
+	explicit					  FrameProfiler(size_t window = 1000);
+
+	// Starts a new frame, returning its number
+	uint64_t					  begin_frame();
+	[[nodiscard]] uint64_t		  frame() const;
+
+	// Milliseconds spent in `scope` by `frame`
+	void						  add(uint64_t frame, Scope scope, double milliseconds);
+
+	// Over the frames of the window that have a sample for `scope`, none when no frame has
+	[[nodiscard]] std::optional<Percentiles> percentiles(Scope scope) const;
+
+	// One row per frame and one column per scope, in milliseconds, missing samples being left empty
+	void						  write_csv(std::ostream &os) const;
+	// Percentiles of every scope followed by the same rows as the CSV, missing samples being null
+	void						  write_json(std::ostream &os) const;
+
+	static std::string_view		  name(Scope scope);
+
+private:
+	struct Row {
+		uint64_t										frame;
+		std::array<std::optional<double>, SCOPE_COUNT> milliseconds;
+	};
+
+	size_t								  _window;
+	std::deque<Row>						  _rows;
+	uint64_t							  _next{};
+	std::chrono::steady_clock::time_point _frameStart;
+};
+
+} // namespace graphics
+
+#endif // SCOP_FRAME_PROFILER_H
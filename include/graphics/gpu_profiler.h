@@ -0,0 +1,54 @@
+#ifndef SCOP_GPU_PROFILER_H
+#define SCOP_GPU_PROFILER_H
+
+#include "frame_profiler.h"
+
+#include <array>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace graphics {
+
+// Timestamp queries around the GPU passes of each frame in flight. Results are read back without waiting once the
+// frame's fence has been, so they never stall the CPU, and handed to a FrameProfiler under the number of the frame
+// that wrote them. Does nothing on queues without timestamp support.
+class GpuProfiler {
+public:
+	enum class Pass : uint8_t {
+		UPLOAD,
+		RENDER_PASS,
+	};
+
+	GpuProfiler(VkDevice device, const VkPhysicalDevice &physical, uint32_t queueFamily, uint32_t framesInFlight);
+	~GpuProfiler();
+
+	GpuProfiler(const GpuProfiler &)			= delete;
+	GpuProfiler &operator=(const GpuProfiler &) = delete;
+
+	// Must be recorded before any pass of `frame_idx`, outside of a render pass; `frame` is the profiler's frame number
+	void		 reset(VkCommandBuffer cmdBuffer, uint32_t frame_idx, uint64_t frame);
+	void		 begin(VkCommandBuffer cmdBuffer, uint32_t frame_idx, Pass pass) const;
+	void		 end(VkCommandBuffer cmdBuffer, uint32_t frame_idx, Pass pass) const;
+
+	// Hands over the timings of the last submission of `frame_idx`, to be called once its fence has been waited on
+	void		 collect(uint32_t frame_idx, FrameProfiler &profiler);
+
+private:
+	static constexpr uint32_t PASS_COUNT	   = static_cast<uint32_t>(Pass::RENDER_PASS) + 1;
+	static constexpr uint32_t QUERIES_PER_FRAME = PASS_COUNT * 2;
+
+	[[nodiscard]] uint32_t	  query(uint32_t frame_idx, Pass pass) const;
+
+	VkDevice				  _device;
+	VkQueryPool				  _pool{};
+	// Nanoseconds per tick, and the bits of a timestamp that are meaningful
+	double					  _period{};
+	uint64_t				  _mask{};
+	// Frame number whose queries are pending for each frame in flight
+	std::vector<std::optional<uint64_t>> _pending;
+};
+
+} // namespace graphics
+
+#endif // SCOP_GPU_PROFILER_H
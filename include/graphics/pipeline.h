@@ -1,17 +1,32 @@
 #ifndef SCOP_PIPELINE_H
 #define SCOP_PIPELINE_H
 
+#include "graphics/reflection.h"
 #include "graphics/shaders.h"
 
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <vulkan/vulkan_core.h>
 
 namespace graphics {
 
+// Uniform buffers there are bound at a dynamic offset, set for each draw: objects then share one descriptor set and buffer
+constexpr uint32_t OBJECT_UNIFORMS_BINDING = 2;
+
+// What a pipeline is specialized on, through the specialization constants of its shaders: the same SPIR-V serves every
+// variant, the driver folding the constants away instead of branching on them at runtime
+struct PipelineVariant {
+	// Samples the texture bound to the draw, the material color being used alone otherwise
+	bool textured{true};
+
+	auto operator<=>(const PipelineVariant &) const = default;
+};
+
 class Pipeline {
 public:
-		 Pipeline(VkDevice &device, std::string vertex_path, std::string fragment_path, VkSampleCountFlagBits msaaSamples);
+		 Pipeline(VkDevice &device, std::shared_ptr<resources::Shader> vertex, std::shared_ptr<resources::Shader> fragment,
+				  VkSampleCountFlagBits msaaSamples, uint32_t textureSlots);
 	~	 Pipeline();
 
 		 Pipeline(Pipeline &&other)				   = default;
@@ -19,41 +34,120 @@ public:
 
 private:
 	static auto create_module(const VkDevice &device, const std::vector<uint32_t> &shader, const std::string &stage) -> VkShaderModule;
+
+public:
 	struct ShaderData {
 		std::optional<VkShaderModule>				   module;
 		std::optional<VkPipelineShaderStageCreateInfo> stage;
 		std::shared_ptr<resources::Shader>			   resource;
+		// What the module expects to be bound, the layout being derived from it
+		std::optional<resources::ShaderReflection>	   reflection;
 
 		explicit									   ShaderData(std::shared_ptr<resources::Shader> res) : resource(std::move(res)) {
 		}
 	};
 
+private:
+	static void		   setup_shader_module(const VkDevice &device, const std::string &stage_name, ShaderData &data);
+	[[nodiscard]] auto current_stages() const -> std::vector<VkPipelineShaderStageCreateInfo>;
+	[[nodiscard]] auto vertex_attributes() const -> std::vector<VkVertexInputAttributeDescription>;
+	[[nodiscard]] auto create_graphics_pipeline(const std::vector<VkPipelineShaderStageCreateInfo> &shaderStages, const PipelineVariant &variant,
+												VkPipelineCache cache) const -> VkPipeline;
+
 
 public:
-	[[nodiscard]] auto compile_shaders() const -> bool;
+	// Shaders are compiled ahead, see resources::Shader::compile_async
+	[[nodiscard]] auto shaders_compiled() const -> bool;
 	[[nodiscard]] auto get_num_errors() const -> std::pair<size_t, size_t>;
 	[[nodiscard]] auto errors() const -> std::string;
 
 	void			   setup_shader_modules();
-	void			   setup_render_pass(const VkFormat &format, const VkFormat &depthFormat);
+	// `finalLayout` is what the resolved color image is left in: ready to present, or to copy out when rendering offscreen.
+	// With `occlusion`, frames are drawn in two passes: `earlyRenderPass` clears and keeps the depth for compute to read,
+	// and `renderPass` goes on from what it left.
+	void			   setup_render_pass(const VkFormat &format, const VkFormat &depthFormat, VkImageLayout finalLayout, bool occlusion = false);
 	void			   create_descriptor_set_layout();
-	void			   setup(const VkExtent2D &extent);
+	void			   setup(VkPipelineCache cache);
+
+	// Enough descriptors for `setCount` sets of the layout
+	[[nodiscard]] auto descriptor_pool_sizes(uint32_t setCount) const -> std::vector<VkDescriptorPoolSize>;
+
+	// Pipeline for `variant`, created on first use through `cache`
+	[[nodiscard]] auto get(const PipelineVariant &variant) -> VkPipeline;
+	[[nodiscard]] auto variants() const -> std::vector<PipelineVariant>;
+
+	// `variants` of the current pipeline but for the shader of one stage, built without touching the current ones so that
+	// it can run on another thread while frames are recorded. Throws if the shader's bindings, push constants or inputs
+	// changed: the layout and descriptor sets built from the old ones are kept, such edits need a restart.
+	struct Replacement {
+		std::string								 stage;
+		ShaderData								 data;
+		std::map<PipelineVariant, VkPipeline>	 pipelines;
+	};
+	[[nodiscard]] auto rebuild(const std::string &stage_name, std::shared_ptr<resources::Shader> shader, const std::vector<PipelineVariant> &variants) const
+		-> Replacement;
+	// Swaps `replacement` in, returning the pipelines and module it replaced: they are the caller's to destroy once no frame
+	// in flight uses them anymore. Variants missing from `replacement` are created again on their next use.
+	auto			   replace(Replacement replacement) -> std::pair<std::vector<VkPipeline>, VkShaderModule>;
 
 private:
 	std::unordered_map<std::string, ShaderData> shaders;
 
 	std::reference_wrapper<VkDevice>			device;
 	VkRenderPass								renderPass{};
+	// Compatible with `renderPass`, so that pipelines and framebuffers serve both
+	VkRenderPass								earlyRenderPass{};
 	VkDescriptorSetLayout						descriptorSetLayout{};
+	// Bindings of the layout, merged across stages from the shaders' reflection
+	std::vector<VkDescriptorSetLayoutBinding>	bindings;
+	// Stages sharing the push constant block, all of which have to be named when pushing
+	VkShaderStageFlags							pushConstantStages{};
 	VkPipelineLayout							layout{};
-	VkPipeline									pipeline{};
+	VkPipelineCache								cache{};
+	std::map<PipelineVariant, VkPipeline>		pipelines;
 	VkSampleCountFlagBits					   msaaSamples{VK_SAMPLE_COUNT_1_BIT};
+	// Size of the fragment shader's sampler array, indexed per draw with the `textureSlot` push constant
+	uint32_t									textureSlots{1};
 
 public:
 		 Pipeline()								   = delete;
 		 Pipeline(const Pipeline &)				   = delete;
 	auto operator=(const Pipeline &) -> Pipeline & = delete;
 
+	friend class ComputePipeline;
+	friend class VulkanInstance;
+};
+
+// Pipeline of a single compute shader, laid out from its reflection like Pipeline's: one descriptor set, and a push
+// constant range when the shader declares a block
+class ComputePipeline {
+public:
+		 ComputePipeline(VkDevice &device, std::shared_ptr<resources::Shader> shader);
+	~	 ComputePipeline();
+
+		 ComputePipeline(ComputePipeline &&other)				 = default;
+	auto operator=(ComputePipeline &&other) -> ComputePipeline & = default;
+
+	// Throws with the compiler's messages if the shader didn't compile
+	void			   setup(VkPipelineCache cache);
+
+	// Enough descriptors for `setCount` sets of the layout
+	[[nodiscard]] auto descriptor_pool_sizes(uint32_t setCount) const -> std::vector<VkDescriptorPoolSize>;
+
+private:
+	Pipeline::ShaderData					  shader;
+
+	std::reference_wrapper<VkDevice>		  device;
+	VkDescriptorSetLayout					  descriptorSetLayout{};
+	std::vector<VkDescriptorSetLayoutBinding> bindings;
+	VkPipelineLayout						  layout{};
+	VkPipeline								  pipeline{};
+
+public:
+		 ComputePipeline()										 = delete;
+		 ComputePipeline(const ComputePipeline &)				 = delete;
+	auto operator=(const ComputePipeline &) -> ComputePipeline & = delete;
+
 	friend class VulkanInstance;
 };
 
@@ -0,0 +1,37 @@
+#ifndef SCOP_PIPELINE_CACHE_H
+#define SCOP_PIPELINE_CACHE_H
+
+#include <filesystem>
+#include <vulkan/vulkan_core.h>
+
+namespace graphics {
+
+// VkPipelineCache loaded from disk on creation and written back on destruction, so pipelines built by a previous run
+// aren't compiled again by the driver. The data is only handed to the driver when it was saved by the same vendor, device
+// and driver version with the same cache UUID, anything else starts empty. Failing to save it is reported but never fatal.
+class PipelineCache {
+public:
+	// An empty directory disables persistence, the cache then only lives as long as this object
+	PipelineCache(VkDevice device, const VkPhysicalDevice &physical, const std::filesystem::path &directory = default_directory());
+	~PipelineCache();
+
+	PipelineCache(const PipelineCache &)			= delete;
+	PipelineCache &operator=(const PipelineCache &) = delete;
+
+	void		   save() const;
+
+	explicit	   operator VkPipelineCache() const;
+
+	// $XDG_CACHE_HOME/scop/pipelines, or ~/.cache/scop/pipelines
+	static std::filesystem::path default_directory();
+
+private:
+	VkDevice				   _device;
+	VkPhysicalDeviceProperties _properties{};
+	std::filesystem::path	   _path;
+	VkPipelineCache			   _cache{};
+};
+
+} // namespace graphics
+
+#endif // SCOP_PIPELINE_CACHE_H
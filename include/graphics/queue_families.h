@@ -9,6 +9,8 @@ namespace graphics {
 struct QueueFamilyIndices {
 	std::optional<uint32_t> graphicsFamily;
 	std::optional<uint32_t> presentFamily;
+	// The graphics family when it can dispatch compute work too, as is almost always the case
+	std::optional<uint32_t> computeFamily;
 
 	explicit				operator bool() const;
 	explicit				operator std::set<uint32_t>() const;
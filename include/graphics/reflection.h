@@ -0,0 +1,78 @@
+#ifndef SCOP_REFLECTION_H
+#define SCOP_REFLECTION_H
+
+#include <compare>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace graphics::resources {
+
+// Interface of a SPIR-V module as seen from the API: what has to be bound for it to run and what it reads from vertices.
+// Only the first entry point is considered, which is all shaderc ever emits for GLSL.
+struct ShaderReflection {
+	enum class Stage {
+		VERTEX,
+		FRAGMENT,
+		COMPUTE,
+		OTHER,
+	};
+
+	enum class DescriptorType {
+		UNIFORM_BUFFER,
+		STORAGE_BUFFER,
+		COMBINED_IMAGE_SAMPLER,
+		SAMPLED_IMAGE,
+		STORAGE_IMAGE,
+		SAMPLER,
+		UNIFORM_TEXEL_BUFFER,
+		STORAGE_TEXEL_BUFFER,
+		INPUT_ATTACHMENT,
+	};
+
+	struct Binding {
+		uint32_t				set;
+		uint32_t				binding;
+		DescriptorType			type;
+		// Array length, 1 if not an array and 0 for runtime sized ones
+		uint32_t				count;
+		// When the length is a specialization constant: its constant_id, `count` then being its default value
+		std::optional<uint32_t> countSpecId;
+
+		auto					operator<=>(const Binding &) const = default;
+	};
+
+	enum class ScalarType {
+		FLOAT,
+		SINT,
+		UINT,
+	};
+
+	// Stage input with an explicit location, built-ins excluded
+	struct Input {
+		uint32_t   location;
+		ScalarType type;
+		// Bits per component
+		uint32_t   width;
+		uint32_t   components;
+		// Matrices take one location per column
+		uint32_t   columns;
+
+		auto	   operator<=>(const Input &) const = default;
+	};
+
+	Stage				 stage{Stage::OTHER};
+	std::vector<Binding> bindings;
+	std::vector<Input>	 inputs;
+	// Size of the push constant block, 0 without one
+	uint32_t			 pushConstantSize{};
+
+	auto				 operator<=>(const ShaderReflection &) const = default;
+};
+
+// Throws std::runtime_error on malformed or unsupported modules
+[[nodiscard]] ShaderReflection reflect(const std::vector<uint32_t> &spirv);
+
+} // namespace graphics::resources
+
+#endif // SCOP_REFLECTION_H
@@ -3,11 +3,20 @@
 
 #include "queue_families.h"
 
+#include <cstdint>
 #include <GLFW/glfw3.h>
 #include <vulkan/vulkan.h>
 
 namespace graphics {
 class VulkanInstance;
+struct SceneView;
+
+// Throughput lets the CPU record up to every frame in flight ahead of the GPU. Latency waits for all of them to be done
+// and samples input right before recording, so that what is shown is as recent as possible, at the cost of frame rate.
+enum class FramePacing : uint8_t {
+	THROUGHPUT,
+	LATENCY,
+};
 
 class Renderer {
 public:
@@ -23,7 +32,11 @@ private:
 	void			init_surface();
 	void			acquire_queues(const QueueFamilyIndices &indices);
 
-	void			updateUniformBuffer(uint32_t frame_idx) const;
+	// Input callbacks run from there, see FramePacing for when
+	void			poll_events() const;
+
+	// Writes the frame's uniforms and those of every object
+	SceneView		updateUniformBuffer(uint32_t frame_idx) const;
 
 	VulkanInstance *_instance;
 	GLFWwindow	   *_window;
@@ -0,0 +1,34 @@
+#ifndef SCOP_SHADER_CACHE_H
+#define SCOP_SHADER_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace graphics::resources {
+
+// On-disk store of compiled SPIR-V, keyed on everything the compiler's output depends on: the shader's source, its compile
+// options and the compiler version (see Shader::cache_key). The full key is kept in the entry, so a hash collision, a
+// stale or a corrupted entry is only a miss. Failing to write an entry is reported but never fatal.
+class SpirvCache {
+public:
+	// An empty directory disables the cache.
+	explicit									  SpirvCache(std::filesystem::path directory = default_directory());
+
+	[[nodiscard]] std::optional<std::vector<uint32_t>> find(const std::string &key) const;
+	void										  store(const std::string &key, const std::vector<uint32_t> &spirv) const;
+
+	[[nodiscard]] bool							  enabled() const;
+
+	// $XDG_CACHE_HOME/scop/shaders, or ~/.cache/scop/shaders
+	static std::filesystem::path				  default_directory();
+
+private:
+	std::filesystem::path						  _directory;
+};
+
+} // namespace graphics::resources
+
+#endif // SCOP_SHADER_CACHE_H
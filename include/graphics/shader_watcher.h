@@ -0,0 +1,40 @@
+#ifndef SCOP_SHADER_WATCHER_H
+#define SCOP_SHADER_WATCHER_H
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace graphics::resources {
+
+// Reports shader sources written to since it last looked, without ever blocking.
+// Uses inotify on Linux, watching the files' directories since most editors save by replacing the file; elsewhere it falls
+// back to comparing modification times, at most every POLL_INTERVAL.
+class ShaderWatcher {
+public:
+	explicit				 ShaderWatcher(const std::vector<std::string> &paths);
+	~						 ShaderWatcher();
+
+	// Each path at most once, in no particular order
+	std::vector<std::string> changed();
+
+	ShaderWatcher(const ShaderWatcher &)			= delete;
+	ShaderWatcher &operator=(const ShaderWatcher &) = delete;
+
+private:
+	static constexpr auto POLL_INTERVAL = std::chrono::milliseconds(250);
+
+	std::vector<std::string> _paths;
+	int						 _fd{-1};
+	// inotify watch descriptor -> directory it watches
+	std::unordered_map<int, std::filesystem::path> _directories;
+
+	std::vector<std::filesystem::file_time_type>   _mtimes;
+	std::chrono::steady_clock::time_point		   _lastPoll{};
+};
+
+} // namespace graphics::resources
+
+#endif // SCOP_SHADER_WATCHER_H
@@ -1,6 +1,10 @@
 #ifndef SCOP_SHADERS_H
 #define SCOP_SHADERS_H
 
+#include "graphics/shader_cache.h"
+
+#include <future>
+#include <map>
 #include <memory>
 #include <optional>
 #include <regex>
@@ -16,33 +20,52 @@ public:
 		UNKNOWN,
 		VERTEX,
 		FRAGMENT,
+		COMPUTE,
 	};
 
 								 Shader(const Shader &)	   = delete;
 	Shader						&operator=(const Shader &) = delete;
 
-	explicit					 Shader(std::string name = "");
+	// Passed to the preprocessor as `#define <name> <value>`, letting one source be compiled into several variants
+	using Defines = std::map<std::string, std::string>;
+
+	explicit					 Shader(std::string name = "", Defines defines = {});
 
 	auto						 load() -> bool;
 	auto						 load(std::string name) -> bool;
 	auto						 compile() -> bool;
+	// Reads the SPIR-V from `cache` when possible, compiling and storing it there otherwise
+	auto						 compile(const SpirvCache &cache) -> bool;
+	[[nodiscard]] auto			 is_compiled() const -> bool;
+
+	// Loads and compiles `name` on a thread of its own, each shader owning its compiler: the future throws if it can't be
+	// loaded, compilation errors are reported by the shader itself
+	static auto					 compile_async(std::string name, SpirvCache cache, Defines defines = {}) -> std::future<std::shared_ptr<Shader>>;
 
 	[[nodiscard]] auto			 get_num_errors() const -> std::pair<size_t, size_t>;
 	[[nodiscard]] auto			 errors() const -> std::string;
 	[[nodiscard]] auto			 compiled() const -> std::vector<uint32_t>;
 
 	[[nodiscard]] constexpr auto getType() const -> Type;
+	[[nodiscard]] auto			 path() const -> const std::string &;
+	[[nodiscard]] auto			 defines() const -> const Defines &;
+
+	// Everything the SPIR-V depends on: the source, how it is compiled and which compiler does it
+	[[nodiscard]] auto			 cache_key() const -> std::string;
 
 private:
 	void												  load_file();
 
 	std::string											  filename{};
+	Defines												  macros{};
 	Type												  type{};
 
 	std::optional<std::string>							  content{};
 
 	shaderc::Compiler									  compiler;
 	std::unique_ptr<shaderc::CompilationResult<uint32_t>> result;
+	// Set on success, either from `result` or from the cache, in which case there is no `result`
+	std::optional<std::vector<uint32_t>>				  spirv;
 
 	static std::regex									  type_detector;
 };
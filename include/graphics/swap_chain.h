@@ -3,6 +3,8 @@
 
 #include "GLFW/glfw3.h"
 
+#include <optional>
+#include <string_view>
 #include <vector>
 #include <vulkan/vulkan.h>
 
@@ -13,13 +15,18 @@ struct SwapChainSupportDetails {
 	std::vector<VkPresentModeKHR>	 presentModes;
 
 	[[nodiscard]] VkSurfaceFormatKHR chooseSwapSurfaceFormat() const;
-	[[nodiscard]] VkPresentModeKHR	 chooseSwapPresentMode() const;
+	// `preferred` if supported, otherwise MAILBOX if available and FIFO, which every surface supports, if not
+	[[nodiscard]] VkPresentModeKHR	 chooseSwapPresentMode(std::optional<VkPresentModeKHR> preferred = std::nullopt) const;
 	[[nodiscard]] VkExtent2D		 chooseSwapExtent(GLFWwindow *window) const;
 
 	explicit						 operator bool() const;
 };
 
-SwapChainSupportDetails query_swap_chain_support(VkPhysicalDevice device, VkSurfaceKHR surface);
+SwapChainSupportDetails			query_swap_chain_support(VkPhysicalDevice device, VkSurfaceKHR surface);
+
+// As given on the command line: immediate, mailbox, fifo or fifo-relaxed
+std::optional<VkPresentModeKHR> parse_present_mode(std::string_view name);
+const char					   *present_mode_name(VkPresentModeKHR mode);
 } // namespace graphics
 
 #endif // SCOP_SWAP_CHAIN_H
@@ -1,22 +1,45 @@
 #ifndef TEXTURES_HPP
 #define TEXTURES_HPP
 
+#include <cstdint>
 #include <memory>
 #include <string>
-#include <vulkan/vulkan_core.h>
 
 namespace graphics::resources {
 
 struct Texture {
+	// Pixel layout in memory; block-compressed formats store 4x4 texel blocks, sRGB encoded like the RGBA8 one
+	enum class Format : uint8_t {
+		RGBA8_SRGB,
+		BC1_RGBA_SRGB,
+		BC7_SRGB,
+	};
+
+	// Every mip level, tightly packed from the largest one down
 	std::shared_ptr<uint8_t> pixels;
 	size_t					 w;
 	size_t					 h;
 	size_t					 channels;
+	uint32_t				 levels{1};
+	Format					 format{Format::RGBA8_SRGB};
 
-	VkDeviceSize			 device_size() const;
+	size_t					 level_width(uint32_t level) const;
+	size_t					 level_height(uint32_t level) const;
+	size_t					 level_offset(uint32_t level) const;
+	size_t					 level_size(uint32_t level) const;
+
+	// Size of the whole mip chain
+	size_t					 device_size() const;
 	explicit				 operator bool() const;
 
+	[[nodiscard]] bool		 compressed() const;
+
+	static uint32_t			 mip_count(size_t w, size_t h);
+	// Bytes per 4x4 block for compressed formats, per texel otherwise
+	static size_t			 block_bytes(Format format);
 	static Texture			 load(const std::string &path = "");
+	// 1x1 RGBA texture of a single color, used for materials without a diffuse map
+	static Texture			 solid(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255);
 };
 
 } // namespace graphics::resources
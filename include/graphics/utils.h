@@ -1,6 +1,7 @@
 #ifndef SCOP_UTILS_H
 #define SCOP_UTILS_H
 
+#include "geometry/mesh.h"
 #include "maths/mat.h"
 #include "maths/vec.h"
 
@@ -11,41 +12,55 @@ namespace graphics {
 extern const std::vector<const char *> VALIDATION_LAYERS;
 extern const std::vector<const char *> DEVICE_EXTENSIONS;
 
-std::vector<const char *>			   get_required_extensions();
+// Headless instances and devices go without the window system and swapchain extensions
+std::vector<const char *>			   get_required_extensions(bool headless = false);
+std::vector<const char *>			   get_device_extensions(bool headless = false);
 bool								   check_validation_layer_support();
-bool								   check_device_extension_support(VkPhysicalDevice physicalDevice);
-VkSampleCountFlagBits				   get_max_usable_sample_count(const VkPhysicalDevice &physical);
+bool								   check_device_extension_support(VkPhysicalDevice physicalDevice, bool headless = false);
+// With `sampledDepth`, only counts a depth image can also be sampled with
+VkSampleCountFlagBits				   get_max_usable_sample_count(const VkPhysicalDevice &physical, bool sampledDepth = false);
 
-struct VertexData {
-	bool operator==(const VertexData &rhs) const {
-		return std::tie(position, color, tex) == std::tie(rhs.position, rhs.color, rhs.tex);
-	}
-
-	bool operator!=(const VertexData &rhs) const {
-		return !(*this == rhs);
-	}
-
-	static VkVertexInputBindingDescription					getBindingDesc();
-	static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescs();
+// Vertex buffers: vertices at binding 0 and, at binding 1, the transform of each instance drawn
+struct VertexData : geometry::Vertex {
+	static std::array<VkVertexInputBindingDescription, 2>	getBindingDescs();
+	static std::array<VkVertexInputAttributeDescription, 7> getAttributeDescs();
+};
 
-	maths::Vec3												position;
-	maths::Vec3												color;
-	maths::Vec2												tex;
+// Binding 0, once per frame: the projection is premultiplied with the view rather than for every vertex
+struct FrameUniforms {
+	alignas(16) maths::Mat4 viewProj{};
 };
 
-struct UniformBufferObject {
+// Binding OBJECT_UNIFORMS_BINDING, once per object at a dynamic offset
+struct ObjectUniforms {
 	alignas(16) maths::Mat4 model{};
-	alignas(16) maths::Mat4 view{};
-	alignas(16) maths::Mat4 proj{};
 };
 
-} // namespace graphics
+// Camera and animation of a frame, which its uniforms are derived from: `model` moves the whole scene, objects being
+// placed within it
+struct SceneView {
+	maths::Mat4 model;
+	maths::Mat4 view;
+	maths::Mat4 proj;
+};
 
-template <>
-struct std::hash<graphics::VertexData> {
-	std::size_t operator()(const graphics::VertexData &vertex_data) const noexcept {
-		return std::hash<maths::Vec3>{}(vertex_data.position) ^ std::hash<maths::Vec3>{}(vertex_data.color) ^ std::hash<maths::Vec2>{}(vertex_data.tex);
-	}
+// What the culling pass of a frame reads first, followed by the model of every object: see shaders/cull.glsl. With
+// occlusion culling, the draws of the second pass follow the `drawCount` of the first.
+struct alignas(16) CullUniforms {
+	std::array<std::array<float, 4>, 6> planes{};
+	maths::Mat4							viewProj{};
+	uint32_t							instanceCount{};
+	uint32_t							drawCount{};
 };
 
+// Bounds of an object in its own space, and its draws: [firstDraw, firstDraw + drawCount) in the list of draws by object
+struct CullObject {
+	std::array<float, 3> boundsMin;
+	uint32_t			 firstDraw;
+	std::array<float, 3> boundsMax;
+	uint32_t			 drawCount;
+};
+
+} // namespace graphics
+
 #endif // SCOP_UTILS_H
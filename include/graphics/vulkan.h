@@ -1,11 +1,20 @@
 #ifndef SCOP_VULKAN_H
 #define SCOP_VULKAN_H
 
+#include "assets/texture_streaming.h"
+#include "assets/thread_pool.h"
+#include "frame_profiler.h"
+#include "geometry/bvh.h"
+#include "gpu_profiler.h"
 #include "pipeline.h"
+#include "pipeline_cache.h"
 #include "renderer.h"
+#include "shader_watcher.h"
 #include "textures.h"
 #include "utils.h"
 
+#include <future>
+#include <span>
 #include <vector>
 #include <vulkan/vulkan.h>
 
@@ -14,10 +23,47 @@ namespace graphics {
 constexpr auto	   ENGINE		  = "gb_engine";
 constexpr uint32_t ENGINE_VERSION = VK_MAKE_VERSION(1, 0, 0);
 
+// Frames the CPU may record ahead of the GPU, each with its own fence, command buffers and regions of the per-frame buffers
+constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+
+// Image holding the levels [base, source.levels) of a texture, `source` being kept around to stream the others in
+struct TextureObject {
+	VkImage			   img{};
+	VkImageView		   view{};
+	VkDeviceMemory	   memory{};
+	VkFormat		   format{};
+	uint32_t		   mipLevels{};
+	resources::Texture source{};
+};
+
+// Part of the scene mesh placed on its own, the submeshes [firstSubmesh, firstSubmesh + submeshCount), drawn once per
+// instance: `instances` place each copy relative to the object
+struct SceneObject {
+	uint32_t				 firstSubmesh;
+	uint32_t				 submeshCount;
+	maths::Mat4				 transform{maths::Mat4::identity};
+	std::vector<maths::Mat4> instances{maths::Mat4::identity};
+};
+
+// One vkCmdDrawIndexed: a range of the index buffer of a single object, sampled with a single texture or with none at all,
+// for every instance of the object. Those are [firstInstance, firstInstance + instanceCount) in the instance buffer.
+struct DrawBatch {
+	std::optional<uint32_t> texture;
+	uint32_t				object;
+	uint32_t				firstIndex;
+	uint32_t				indexCount;
+	uint32_t				firstInstance;
+	uint32_t				instanceCount;
+
+	bool					operator==(const DrawBatch &) const = default;
+};
+
 class VulkanInstance {
 public:
-	 VulkanInstance();
-	~VulkanInstance();
+	// Headless with an offscreen extent: frames are rendered into images of that size instead of a swapchain, nothing
+	// touching the window system
+	explicit VulkanInstance(std::optional<VkExtent2D> offscreen = std::nullopt);
+	~		 VulkanInstance();
 
 private:
 	void	 create_instance();
@@ -34,6 +80,48 @@ public:
 		_msaaSamples = msaaSamples;
 	}
 
+	// Must be called before create_texture_objects
+	void set_texture_budget(const size_t bytes) {
+		auto config			= _streamer.config();
+		config.memoryBudget = bytes;
+		_streamer			= assets::TextureStreamer(config);
+	}
+
+	// Command buffers recorded once per (swapchain image, frame in flight) and submitted again until the draws, pipelines,
+	// descriptor sets or swapchain they were recorded against change: frames then only update the UBO
+	void set_record_once(const bool recordOnce) {
+		_recordOnce = recordOnce;
+	}
+
+	// Must be called before create_device, everything kept per frame in flight being sized from it
+	void set_frames_in_flight(const uint32_t framesInFlight) {
+		_framesInFlight = framesInFlight;
+	}
+
+	[[nodiscard]] uint32_t frames_in_flight() const {
+		return _framesInFlight;
+	}
+
+	// Both taken when the surface supports them, otherwise MAILBOX if available and FIFO if not, and one image more than
+	// the minimum. Must be called before create_swapchain
+	void set_present_mode(const std::optional<VkPresentModeKHR> presentMode) {
+		_presentMode = presentMode;
+	}
+
+	void set_swapchain_images(const std::optional<uint32_t> count) {
+		_swapchainImageCount = count;
+	}
+
+	void set_frame_pacing(const FramePacing pacing) {
+		_framePacing = pacing;
+	}
+
+	// GPU-driven only, must be called before create_pipeline: frames are drawn in two passes, the first drawing what was
+	// visible last frame and the second what a depth pyramid built from the first's depth doesn't hide, see DepthPyramid
+	void set_occlusion_culling(const bool occlusionCulling) {
+		_occlusionCulling = occlusionCulling;
+	}
+
 	[[nodiscard]] VkSurfaceKHR					get_surface() const;
 
 	[[nodiscard]] std::vector<VkPhysicalDevice> enumerate_physical_devices() const;
@@ -41,25 +129,57 @@ public:
 	void										create_device(VkPhysicalDevice device);
 	void										create_swapchain(VkPhysicalDevice physical);
 	void										create_image_views();
-	void										create_pipeline(const VkPhysicalDevice &physical, std::string vertex_shader, std::string fragment_shader);
+	// Must be called after create_texture_objects, the descriptor set layout holds every texture
+	void										create_pipeline(const VkPhysicalDevice &physical, std::shared_ptr<resources::Shader> vertex,
+																std::shared_ptr<resources::Shader> fragment);
+	// GPU-driven rendering: a compute pass culls every instance and writes the frame's indirect draws, the CPU recording
+	// the same few draws whatever the scene. Must be called after create_pipeline, whose vertex shader is then expected to
+	// be compiled with GPU_DRIVEN defined.
+	void										create_cull_pipeline(const VkPhysicalDevice &physical, std::shared_ptr<resources::Shader> shader);
+	[[nodiscard]] bool							gpu_driven() const;
+	// Occlusion culling's reduction of the depth into the pyramid, its shader compiled with SAMPLES defined as the MSAA
+	// sample count: must be called after create_cull_pipeline, whose shader is then expected to have OCCLUSION defined
+	void										create_pyramid_pipeline(std::shared_ptr<resources::Shader> shader);
+	// Rebuilds the pipeline in the background whenever one of its shaders is modified on disk
+	void										watch_shaders();
 	void										create_framebuffers();
 	void										create_command_pool(const VkPhysicalDevice &physical);
 	void										create_short_lived_command_pool(const VkPhysicalDevice &physical);
 	void										create_command_buffers();
+	// Draws of large scenes are split across threads into secondary command buffers, which the primary then executes
 	void										record_command_buffer(VkCommandBuffer command_buffer, uint32_t image_idx, uint32_t frame_idx) const;
 	void										create_sync_objects();
+	// Timestamp queries around the GPU passes, read back into profiler()
+	void										create_gpu_profiler(const VkPhysicalDevice &physical);
 	void										create_vertex_buffer(const VkPhysicalDevice &physical);
 	void										create_index_buffer(const VkPhysicalDevice &physical);
+	void										create_instance_buffer(const VkPhysicalDevice &physical);
+	// What the culling pass reads and writes, GPU-driven only: must be called after create_instance_buffer
+	void										create_cull_buffers(const VkPhysicalDevice &physical);
 	void										create_uniform_buffers(const VkPhysicalDevice &physical);
 	void										create_descriptor_pool();
 	void										create_descriptor_sets();
-	void										create_texture_object(const VkPhysicalDevice &physical, std::string path);
-	void										create_tex_img_view();
+	// Materials mapped to no texture are drawn with their color alone. Every submesh belongs to one of `objects`.
+	void										set_geometry(geometry::Mesh mesh, const std::vector<std::optional<uint32_t>> &materialTextures,
+															 std::vector<SceneObject> objects);
+	// Places `instance` of `object` anew, from the next frame on. Culling refits its bounds rather than rebuilding the
+	// tree, texture streaming keeps estimating sizes from where set_geometry placed it.
+	void										move_instance(uint32_t object, uint32_t instance, const maths::Mat4 &transform);
+	// Whether textures in `format` can be sampled on `physical`, compressed formats falling back to RGBA8 otherwise
+	[[nodiscard]] static bool					supports_texture_format(const VkPhysicalDevice &physical, resources::Texture::Format format);
+	void										create_texture_objects(const VkPhysicalDevice &physical, const std::vector<resources::Texture> &textures);
+	void										create_tex_img_views();
 	void										create_tex_sampler(const VkPhysicalDevice &physical);
 	void										create_depth_img(const VkPhysicalDevice &physical);
 	void										create_color_resources(const VkPhysicalDevice &physical);
 
 	void										render(VkPhysicalDevice physical, uint32_t frame_idx) const;
+	[[nodiscard]] const FrameProfiler		   &profiler() const;
+	[[nodiscard]] bool							headless() const;
+	// Whether the last frame was drawn with every texture level it wanted, none being left to stream in
+	[[nodiscard]] bool							textures_settled() const;
+	// RGBA8 pixels of the offscreen image `frame_idx` last rendered to, rows top to bottom. Waits for the device to idle.
+	[[nodiscard]] std::vector<uint8_t>			read_back(const VkPhysicalDevice &physical, uint32_t frame_idx) const;
 	void										waitIdle() const;
 
 	void										mark_framebuffer_resized();
@@ -67,15 +187,63 @@ public:
 	void										recreate_swapchain(VkPhysicalDevice physical);
 
 private:
-	void								init_geometry();
-
 	std::pair<VkBuffer, VkDeviceMemory> create_buffer(const VkPhysicalDevice &physical, VkDeviceSize size, VkBufferUsageFlags usage,
 													  VkMemoryPropertyFlags properties) const;
+	// Device local buffer holding `size` bytes of `data`, uploaded through a staging buffer
+	std::pair<VkBuffer, VkDeviceMemory> create_static_buffer(const VkPhysicalDevice &physical, const void *data, VkDeviceSize size,
+															 VkBufferUsageFlags usage) const;
 	std::pair<VkImage, VkDeviceMemory>	create_image(VkPhysicalDevice physical, size_t w, size_t h, uint32_t mipLevels, VkSampleCountFlagBits numSamples,
 													 VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags props) const;
-	std::optional<VkImageView>			create_image_view(VkImage image, VkFormat format, const VkImageAspectFlags &aspectFlags, uint32_t mipLevels) const;
-
-	static VkFormat						find_depth_format(const VkPhysicalDevice &physical);
+	std::optional<VkImageView>			create_image_view(VkImage image, VkFormat format, const VkImageAspectFlags &aspectFlags, uint32_t mipLevels,
+														  uint32_t baseLevel = 0) const;
+	TextureObject						create_texture_object(const VkPhysicalDevice &physical, const resources::Texture &texture, bool generateMips,
+															  uint32_t base) const;
+	void								destroy_texture_object(const TextureObject &texture) const;
+	// How many textures a single descriptor set can hold, past that they are split across several sets
+	static uint32_t						max_texture_slots(const VkPhysicalDevice &physical);
+	[[nodiscard]] uint32_t				texture_groups() const;
+	void								write_texture_descriptor(uint32_t frame, uint32_t texture);
+
+	// Texture streaming, see texture_streaming.cpp
+	void								stream_textures(const VkPhysicalDevice &physical, uint32_t frame_idx, const SceneView &view);
+	void								update_screen_sizes(const SceneView &view);
+	void								reserve_staging(const VkPhysicalDevice &physical, uint32_t frame_idx, VkDeviceSize size);
+	void								reallocate_texture(const VkPhysicalDevice &physical, VkCommandBuffer cmdBuffer, uint32_t frame_idx,
+														   const assets::TextureStreamer::Reallocation &reallocation);
+	void upload_texture_level(VkCommandBuffer cmdBuffer, uint32_t frame_idx, const assets::TextureStreamer::Upload &upload, VkDeviceSize offset) const;
+
+	// Frustum culling, see culling.cpp: writes the transforms of the instances of the frame's view to its region of the
+	// instance buffer and derives the frame's draws from them
+	void								cull(uint32_t frame_idx, const SceneView &view);
+	// GPU-driven counterpart, which only writes the view the culling pass reads and the instances moved since
+	void								write_cull_view(uint32_t frame_idx, const SceneView &view);
+	// The culling pass, ahead of the render pass it feeds: with occlusion culling, `late` is the one following the pyramid
+	void								record_cull_pass(VkCommandBuffer command_buffer, uint32_t frame_idx, bool late = false) const;
+	// Occlusion culling's pyramid, sized after the depth image, and its reduction between the two render passes
+	void								create_depth_pyramid(const VkPhysicalDevice &physical);
+	void								write_pyramid_descriptors();
+	void								record_depth_pyramid(VkCommandBuffer command_buffer) const;
+
+	// Shader hot reload, see shader_reload.cpp
+	void								reload_shaders();
+	void								destroy_retired_pipelines(bool all);
+
+	void								create_offscreen_images(const VkPhysicalDevice &physical);
+
+	// Command buffer drawing the frame into `image_idx`, recorded now or, in record-once mode, only if it went stale
+	VkCommandBuffer						frame_command_buffer(uint32_t image_idx, uint32_t frame_idx);
+	// Marks the record-once command buffers of `frame`, or of every frame, as needing to be recorded again
+	void								invalidate_command_buffers(std::optional<uint32_t> frame = std::nullopt);
+	// Where the uniforms of `frame`, and of an object in it, are in `_uniformRing`
+	[[nodiscard]] VkDeviceSize			frame_uniforms_offset(uint32_t frame) const;
+	[[nodiscard]] VkDeviceSize			object_uniforms_offset(uint32_t frame, uint32_t object) const;
+	// Binds everything `batches` need and draws them, inside the render pass begun by the primary command buffer. With
+	// occlusion culling, `late` draws the second render pass's commands.
+	void record_draws(VkCommandBuffer command_buffer, uint32_t frame_idx, std::span<const DrawBatch> batches, bool late = false) const;
+
+	// `sampled` when occlusion culling reads it into the depth pyramid
+	static VkFormat						find_depth_format(const VkPhysicalDevice &physical, bool sampled);
+	static bool							supports_linear_blit(const VkPhysicalDevice &physical, VkFormat format);
 	constexpr static bool				has_stencil_component(const VkFormat format) {
 		  return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
 	}
@@ -88,55 +256,186 @@ private:
 
 	void			copy_buffer(VkBuffer src, VkBuffer dst, VkDeviceSize size) const;
 	void			transition_image_layout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels) const;
-	void			copy_buffer_to_image(VkBuffer buffer, VkImage image, uint32_t w, uint32_t h) const;
+	void			copy_buffer_to_image(VkBuffer buffer, VkImage image, const resources::Texture &texture, uint32_t base) const;
 	void	   generate_mip_maps(const VkPhysicalDevice &physical, const VkImage &img, const VkFormat &format, size_t w, size_t h, uint32_t mipLevels) const;
 
 	VkInstance _instance{};
 	VkDebugUtilsMessengerEXT	 _debugMessenger{};
 	std::shared_ptr<Renderer>	 _renderer;
 
+	// Stands in for the swapchain when headless, `_swapchainImages` then being images of our own
+	std::optional<VkExtent2D>	 _offscreen;
+	std::vector<VkDeviceMemory>	 _offscreenMemory;
+
 	VkSwapchainKHR				 _swapchain{};
 	std::vector<VkImage>		 _swapchainImages;
 	std::vector<VkImageView>	 _swapchainImageViews;
 	VkExtent2D					 _swapchainExtent{};
 	VkFormat					 _swapchainFormat{};
+	// Requested, see set_present_mode
+	std::optional<VkPresentModeKHR> _presentMode;
+	std::optional<uint32_t>			_swapchainImageCount;
 
+	std::unique_ptr<PipelineCache> _pipelineCache{nullptr};
 	std::unique_ptr<Pipeline>	 _pipeline{nullptr};
+
+	// At most one replacement pipeline is built at a time, on a thread of its own, and swapped in at a frame boundary.
+	// What it replaces is destroyed once every frame that could have used it has been waited on.
+	struct RetiredPipeline {
+		std::vector<VkPipeline> pipelines;
+		VkShaderModule			module;
+		uint32_t				framesLeft;
+	};
+	std::unique_ptr<resources::ShaderWatcher> _shaderWatcher;
+	std::vector<std::string>				  _staleShaders;
+	std::future<Pipeline::Replacement>		  _pendingPipeline;
+	std::vector<RetiredPipeline>			  _retiredPipelines;
 	std::vector<VkFramebuffer>	 _framebuffers;
 	bool						 _framebufferResized{false};
 
 	VkCommandPool				 _commandPool{};
 	std::vector<VkCommandBuffer> _commandBuffers;
+	std::vector<VkCommandBuffer> _uploadCommandBuffers;
 
 	VkCommandPool				 _shortLivedCommandPool{};
 
+	// Threads recording draws, and a pool with one secondary command buffer per (frame in flight, thread): threads never
+	// share a pool, and a frame's are reset together once its fence is waited on
+	std::unique_ptr<assets::ThreadPool> _recordPool;
+	uint32_t							 _recordThreads{1};
+	std::vector<VkCommandPool>			 _secondaryCommandPools;
+	std::vector<VkCommandBuffer>		 _secondaryCommandBuffers;
+
+	// Record-once mode, indexed by image * frames in flight + frame: a buffer is recorded again before its next use
+	// once its dirty flag is set
+	bool								 _recordOnce{false};
+	std::vector<VkCommandBuffer>		 _staticCommandBuffers;
+	std::vector<bool>					 _staticCommandBuffersDirty;
+
+	uint32_t					 _framesInFlight{DEFAULT_FRAMES_IN_FLIGHT};
+	FramePacing					 _framePacing{FramePacing::THROUGHPUT};
 	std::vector<VkSemaphore>	 _imageAvailableSemaphores;
 	std::vector<VkSemaphore>	 _renderFinishedSemaphores;
 	std::vector<VkFence>		 _inFlightFences;
 
+	// CPU scopes of Renderer::render and, a few frames late, GPU passes
+	FrameProfiler				 _profiler;
+	std::unique_ptr<GpuProfiler> _gpuProfiler;
+
 	VkDescriptorPool			 _descriptorPool{};
 	std::vector<VkDescriptorSet> _descriptorSets;
-	std::vector<VkBuffer>		 _uniformBuffers;
-	std::vector<VkDeviceMemory>	 _uniformBuffersMemory;
-	std::vector<void *>			 _uniformBuffersMapped;
+	// Uniforms of every frame in flight in one persistently mapped buffer, laid out linearly as a region per frame: the
+	// frame's uniforms then each object's, at offsets aligned for dynamic binding. A region is rewritten once its frame's
+	// fence is waited on.
+	VkBuffer					 _uniformRing{};
+	VkDeviceMemory				 _uniformRingMemory{};
+	uint8_t						*_uniformRingMapped{};
+	VkDeviceSize				 _uniformStride{};
+	VkDeviceSize				 _uniformRegionSize{};
 
 	VkDevice					 _device{};
 
-	std::vector<VertexData>		 _vertices{};
+	std::vector<geometry::Vertex> _vertices{};
 	VkBuffer					 _vertexBuffer{};
 	VkDeviceMemory				 _vertexBufferMemory{};
 
 	std::vector<uint32_t>		 _indices;
 	VkBuffer					 _indexBuffer{};
 	VkDeviceMemory				 _indexBufferMemory{};
-
-	resources::Texture			 _tex{};
-	uint32_t					 _mipLevels{};
-	VkImage						 _texImg{};
-	VkImageView					 _texImgView{};
-	VkDeviceMemory				 _texImgMemory{};
-
-	VkSampler					 _sampler{};
+	// Draws of every instance, and those of each frame's visible ones, pointing into the frame's region of the instance buffer
+	std::vector<DrawBatch>		 _batches;
+	std::vector<std::vector<DrawBatch>> _frameBatches;
+	std::vector<SceneObject>	 _objects;
+
+	// Instances of every object one after the other, with the object each belongs to and where each object's start
+	std::vector<maths::Mat4>	 _instances;
+	std::vector<uint32_t>		 _instanceObjects;
+	std::vector<uint32_t>		 _firstInstances;
+	// Per-instance vertex input, persistently mapped: a region per frame in flight, large enough for every instance, which
+	// culling rewrites with the transforms of those visible, each object's together
+	VkBuffer					 _instanceBuffer{};
+	VkDeviceMemory				 _instanceBufferMemory{};
+	uint8_t						*_instanceBufferMapped{};
+	VkDeviceSize				 _instanceRegionSize{};
+
+	// Bounds of each object in its own space, and a tree over those of every instance in the scene's
+	std::vector<geometry::Aabb>	 _objectBounds;
+	geometry::Bvh				 _bvh;
+	// Visible instances found in each part of the tree, and how many of them belong to each object
+	std::vector<std::vector<uint32_t>> _visibleParts;
+	std::vector<uint32_t>		 _visibleCounts;
+
+	// GPU-driven culling. Static buffers hold each object's bounds and draws, each instance's object, and the draw commands
+	// as they are before culling, each batch's having room for every instance of its object. The others have a region per
+	// frame in flight: the view culling reads, and the draw commands and visible instance transforms it writes. Occlusion
+	// culling doubles the draw commands and their room, one set per render pass, and keeps whether each instance was
+	// visible from one frame to the next.
+	struct CullBuffers {
+		std::pair<VkBuffer, VkDeviceMemory> objects{};
+		std::pair<VkBuffer, VkDeviceMemory> objectDraws{};
+		std::pair<VkBuffer, VkDeviceMemory> instanceObjects{};
+		std::pair<VkBuffer, VkDeviceMemory> initialDraws{};
+		std::pair<VkBuffer, VkDeviceMemory> view{};
+		std::pair<VkBuffer, VkDeviceMemory> draws{};
+		std::pair<VkBuffer, VkDeviceMemory> visible{};
+		std::pair<VkBuffer, VkDeviceMemory> visibility{};
+		uint8_t							   *viewMapped{};
+		VkDeviceSize						viewRegionSize{};
+		VkDeviceSize						drawsRegionSize{};
+		VkDeviceSize						visibleRegionSize{};
+	};
+	std::unique_ptr<ComputePipeline> _cullPipeline;
+	std::vector<VkDescriptorSet>	 _cullDescriptorSets;
+	CullBuffers						 _cullBuffers;
+	// Instances each frame's region of the instance buffer still has to be given the new transform of
+	std::vector<std::vector<uint32_t>> _pendingMoves;
+	// 1 without multiDrawIndirect
+	uint32_t						 _maxDrawIndirectCount{1};
+	bool							 _drawIndirectFirstInstance{false};
+
+	// Farthest depth the first render pass left over ever larger squares of pixels: level 0 is the size of the framebuffer,
+	// each texel of the next the farthest of the 2x2 below it. Rebuilt every frame, in the general layout it is both
+	// written and sampled in, and created again with the swapchain.
+	struct DepthPyramid {
+		VkImage					 img{};
+		VkDeviceMemory			 memory{};
+		// Every level, sampled by culling, and each on its own, written by the reduction
+		VkImageView				 view{};
+		std::vector<VkImageView> levelViews;
+		VkExtent2D				 extent{};
+	};
+	// Enough for framebuffers up to 32768 pixels wide
+	static constexpr uint32_t		 MAX_PYRAMID_LEVELS = 16;
+	bool							 _occlusionCulling{false};
+	std::unique_ptr<ComputePipeline> _pyramidPipeline;
+	// One per level the pyramid can have, only as many as it has being written
+	std::vector<VkDescriptorSet>	 _pyramidDescriptorSets;
+	VkSampler						 _pyramidSampler{};
+	DepthPyramid					 _depthPyramid;
+
+	std::vector<TextureObject>	 _textures;
+	// Length of the sampler array of each descriptor set, texture `t` lives in slot `t % _textureSlots` of set `t / _textureSlots`
+	uint32_t					 _textureSlots{1};
+
+	// Indexed by the sampler's minLod, which hides the levels of a texture that aren't uploaded yet
+	std::vector<VkSampler>		 _samplers;
+
+	// Per frame in flight: upload commands, submitted ahead of the frame's own, and what they need kept alive until the
+	// frame's fence is next waited on
+	struct StreamingFrame {
+		VkBuffer				   staging{};
+		VkDeviceMemory			   stagingMemory{};
+		void					  *stagingMapped{};
+		VkDeviceSize			   stagingCapacity{};
+		std::vector<TextureObject> garbage;
+	};
+	assets::TextureStreamer						  _streamer;
+	bool										  _streamingSettled{false};
+	std::vector<StreamingFrame>					  _streamingFrames;
+	// Bounding sphere of the geometry drawn with each texture, to estimate its size on screen
+	std::vector<std::pair<maths::Vec3, float>>	  _textureBounds;
+	// View and minLod each (frame, texture) descriptor was last written with
+	std::vector<std::pair<VkImageView, uint32_t>> _boundImages;
 
 	VkSampleCountFlagBits		 _msaaSamples{VK_SAMPLE_COUNT_1_BIT};
 	VkImage						 _colorImg{};
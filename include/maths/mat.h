@@ -1,6 +1,7 @@
 #ifndef MAT_H
 #define MAT_H
 #include <array>
+#include <cstddef>
 
 // #define MATH_FORCE_DEPTH_ZERO_TO_ONE
 
@@ -13,7 +14,7 @@ class Mat4 {
 	typedef std::array<Line, 4>			Repr;
 
 public:
-	static Mat4 identity;
+	static const Mat4 identity;
 
 	explicit	Mat4(const Line &l1, const Line &l2, const Line &l3, const Line &l4);
 
@@ -33,6 +34,7 @@ public:
 	Mat4		operator-(const Mat4 &other) const;
 	Mat4	   &operator-=(const Mat4 &other);
 
+	// Lines hold columns, so `a * b` is the transform applying `a` then `b`: GLSL's `b * a`
 	Mat4		operator*(const Mat4 &other) const;
 	Mat4	   &operator*=(const Mat4 &other);
 	Mat4		operator*(InternalType lambda) const;
@@ -43,6 +45,10 @@ public:
 
 	Mat4		operator-() const;
 
+	// `p` as a point, w = 1, without the perspective divide
+	Vec3		transform_point(const Vec3 &p) const;
+
+	static Mat4 translate(const Vec3 &offset);
 	static Mat4 rotate(InternalType angle, const Vec3 &u);
 	static Mat4 lookAt(const Vec3 &eye, const Vec3 &center, const Vec3 &arbUp);
 	static Mat4 perspective(float fov, float aspectRatio, float near, float far);
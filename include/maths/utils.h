@@ -1,6 +1,7 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
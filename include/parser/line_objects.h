@@ -46,6 +46,8 @@ struct Face {
 	explicit			 Face(const std::vector<std::string> &args);
 
 	std::vector<Indices> vertices;
+	// Index in File's material names, unset when no `usemtl` precedes the face
+	std::optional<index_type> material;
 };
 } // namespace parser
 
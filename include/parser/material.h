@@ -0,0 +1,38 @@
+#ifndef SCOP_PARSER_MATERIAL_H
+#define SCOP_PARSER_MATERIAL_H
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace parser {
+
+struct Color {
+	Color(float r, float g, float b);
+	explicit Color(const std::vector<std::string> &args);
+
+	float	 r{};
+	float	 g{};
+	float	 b{};
+};
+
+struct Material {
+	explicit				   Material(std::string name = "");
+
+	std::string				   name;
+	Color					   ambient{0.0f, 0.0f, 0.0f};
+	Color					   diffuse{1.0f, 1.0f, 1.0f};
+	Color					   specular{0.0f, 0.0f, 0.0f};
+	float					   shininess{0.0f};
+	float					   dissolve{1.0f};
+	uint32_t				   illum{2};
+
+	// Resolved relative to the MTL file it comes from
+	std::optional<std::string> diffuse_map;
+};
+
+std::vector<Material> parse_mtl(const std::string &filename);
+
+} // namespace parser
+
+#endif // SCOP_PARSER_MATERIAL_H
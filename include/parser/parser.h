@@ -7,7 +7,10 @@
 #include <vector>
 
 namespace parser {
-void parse(const std::string &filename);
+class File;
+
+File parse(const std::string &filename);
+void parse(const std::string &filename, File &file);
 
 class ifs_error : public std::exception {
 public:
@@ -20,7 +23,7 @@ private:
 };
 
 class File {
-	friend void				   parse(const std::string &filename);
+	friend void				   parse(const std::string &filename, File &file);
 
 	void					   triangulate();
 
@@ -30,6 +33,9 @@ class File {
 	std::vector<Face>		   faces;
 	std::vector<Face>		   triangulated;
 
+	std::vector<std::string>   material_libraries;
+	std::vector<std::string>   material_names;
+
 public:
 	decltype(triangulated)::const_iterator begin() const {
 		return triangulated.begin();
@@ -50,9 +56,16 @@ public:
 	decltype(texture_coordinates)::const_reference texCoord(const size_t i) const {
 		return texture_coordinates[i];
 	}
-};
 
-extern File file;
+	// `mtllib` paths, resolved relative to the parsed file
+	const decltype(material_libraries) &materialLibraries() const {
+		return material_libraries;
+	}
+
+	const decltype(material_names) &materialNames() const {
+		return material_names;
+	}
+};
 } // namespace parser
 
 #endif // SCOP_PARSER_H
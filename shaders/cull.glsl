@@ -0,0 +1,144 @@
+#version 450
+#pragma shader_stage(compute)
+
+// One invocation per instance of the scene
+layout(local_size_x = 64) in;
+
+// See graphics::CullUniforms: the frustum in the space objects are placed in and the projection onto the screen, then
+// where each object is this frame
+layout(binding = 0) readonly buffer View {
+	vec4 planes[6];
+	mat4 viewProj;
+	uint instanceCount;
+	uint drawCount;
+	mat4 models[];
+} view;
+
+// See graphics::CullObject: bounds in the object's own space, and its draws as listed in `objectDraws`
+struct Object {
+	vec3 boundsMin;
+	uint firstDraw;
+	vec3 boundsMax;
+	uint drawCount;
+};
+layout(binding = 1) readonly buffer Objects {
+	Object objects[];
+};
+layout(binding = 2) readonly buffer ObjectDraws {
+	uint objectDraws[];
+};
+
+// Placement of each instance relative to its object, and that object
+layout(binding = 3) readonly buffer Instances {
+	mat4 transforms[];
+};
+layout(binding = 4) readonly buffer InstanceObjects {
+	uint instanceObjects[];
+};
+
+// VkDrawIndexedIndirectCommand, whose instance counts start at zero every frame: each draw's visible instances are
+// [firstInstance, firstInstance + instanceCount) in `visible`
+struct DrawCommand {
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int	 vertexOffset;
+	uint firstInstance;
+};
+layout(binding = 5) buffer Draws {
+	DrawCommand draws[];
+};
+layout(binding = 6) writeonly buffer Visible {
+	mat4 visible[];
+};
+
+#ifdef OCCLUSION
+// Whether each instance was drawn last frame. The first pass draws those that were, the second tests every instance
+// against the depth they left and draws those it finds visible that the first didn't, see graphics::VulkanInstance's
+// DepthPyramid.
+layout(binding = 7) buffer Visibility {
+	uint visibility[];
+};
+layout(binding = 8) uniform sampler2D pyramid;
+
+layout(push_constant) uniform Pass {
+	uint late;
+} pass;
+
+// Whether the box is behind the farthest depth over the pixels it covers, read at the level of the pyramid where those
+// are 2x2 texels at most. Boxes reaching behind the eye project onto no bounded rectangle and are kept.
+bool occluded(const vec3 center, const vec3 extent) {
+	vec3 ndcMin = vec3(1e30);
+	vec3 ndcMax = vec3(-1e30);
+	for (uint corner = 0u; corner < 8u; corner++) {
+		const vec3 side = vec3((corner & 1u) != 0u ? 1.0 : -1.0, (corner & 2u) != 0u ? 1.0 : -1.0, (corner & 4u) != 0u ? 1.0 : -1.0);
+		const vec4 clip = view.viewProj * vec4(center + side * extent, 1.0);
+		if (clip.w <= 0.0)
+			return false;
+		ndcMin = min(ndcMin, clip.xyz / clip.w);
+		ndcMax = max(ndcMax, clip.xyz / clip.w);
+	}
+
+	// The viewport maps [-1, 1] onto the whole framebuffer, which level 0 is the size of. A texel of level n covers the
+	// pixels whose coordinates shifted right by n are its own, the last row and column taking what is left over.
+	const ivec2 size  = textureSize(pyramid, 0);
+	const ivec2 lo	  = clamp(ivec2(floor((ndcMin.xy * 0.5 + 0.5) * vec2(size))), ivec2(0), size - 1);
+	const ivec2 hi	  = clamp(ivec2(floor((ndcMax.xy * 0.5 + 0.5) * vec2(size))), ivec2(0), size - 1);
+	const int	span  = max(hi.x - lo.x, hi.y - lo.y) + 1;
+	const int	level = min(span > 1 ? findMSB(span - 1) + 1 : 0, textureQueryLevels(pyramid) - 1);
+
+	const ivec2 levelSize = textureSize(pyramid, level);
+	const ivec2 first	  = min(lo >> level, levelSize - 1);
+	const ivec2 last	  = min(hi >> level, levelSize - 1);
+	float		farthest  = 0.0;
+	for (int y = first.y; y <= last.y; y++) {
+		for (int x = first.x; x <= last.x; x++)
+			farthest = max(farthest, texelFetch(pyramid, ivec2(x, y), level).r);
+	}
+	return ndcMin.z > farthest;
+}
+#endif
+
+void main() {
+	const uint instance = gl_GlobalInvocationID.x;
+	if (instance >= view.instanceCount)
+		return;
+
+	const uint	 objectIdx = instanceObjects[instance];
+	const Object object	   = objects[objectIdx];
+	const mat4	 model	   = view.models[objectIdx] * transforms[instance];
+
+	// Same test as geometry::Frustum, on the box around the object's once placed
+	const vec3	 center	   = (model * vec4((object.boundsMin + object.boundsMax) * 0.5, 1.0)).xyz;
+	const vec3	 halfSize  = (object.boundsMax - object.boundsMin) * 0.5;
+	const vec3	 extent	   = abs(model[0].xyz) * halfSize.x + abs(model[1].xyz) * halfSize.y + abs(model[2].xyz) * halfSize.z;
+	bool		 inside	   = true;
+	for (uint i = 0u; i < 6u && inside; i++) {
+		const vec4 plane = view.planes[i];
+		inside			 = dot(plane.xyz, center) + plane.w >= -dot(abs(plane.xyz), extent);
+	}
+
+#ifdef OCCLUSION
+	const bool drawn = visibility[instance] != 0u;
+	if (pass.late == 0u) {
+		if (!inside || !drawn)
+			return;
+	} else {
+		const bool seen		 = inside && !occluded(center, extent);
+		visibility[instance] = seen ? 1u : 0u;
+		if (!seen || drawn)
+			return;
+	}
+	const uint firstDraw = pass.late * view.drawCount;
+#else
+	if (!inside)
+		return;
+	const uint firstDraw = 0u;
+#endif
+
+	for (uint i = 0u; i < object.drawCount; i++) {
+		const uint draw = firstDraw + objectDraws[object.firstDraw + i];
+		const uint slot = atomicAdd(draws[draw].instanceCount, 1u);
+		visible[draws[draw].firstInstance + slot] = model;
+	}
+}
@@ -0,0 +1,46 @@
+#version 450
+#pragma shader_stage(compute)
+
+// One invocation per texel of the level written
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// Each texel keeps the farthest depth of those it covers, so that a box nearer than it is in front of all of them. The
+// first level is reduced from every sample of the depth buffer, SAMPLES being its sample count, the others each from the
+// level before.
+#if SAMPLES > 1
+layout(binding = 0) uniform sampler2DMS depth;
+#else
+layout(binding = 0) uniform sampler2D depth;
+#endif
+layout(binding = 1, r32f) uniform readonly image2D source;
+layout(binding = 2, r32f) uniform writeonly image2D level;
+
+layout(push_constant) uniform Reduction {
+	uint fromDepth;
+} reduction;
+
+void main() {
+	const ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	const ivec2 size  = imageSize(level);
+	if (any(greaterThanEqual(texel, size)))
+		return;
+
+	float farthest = 0.0;
+	if (reduction.fromDepth != 0u) {
+#if SAMPLES > 1
+		for (int i = 0; i < SAMPLES; i++)
+			farthest = max(farthest, texelFetch(depth, texel, i).r);
+#else
+		farthest = texelFetch(depth, texel, 0).r;
+#endif
+	} else {
+		// 2x2 texels of the level before, and along the last row and column of this one what halving left over
+		const ivec2 first = texel * 2;
+		const ivec2 last  = mix(first + 1, imageSize(source) - 1, equal(texel, size - 1));
+		for (int y = first.y; y <= last.y; y++) {
+			for (int x = first.x; x <= last.x; x++)
+				farthest = max(farthest, imageLoad(source, ivec2(x, y)).r);
+		}
+	}
+	imageStore(level, texel, vec4(farthest));
+}
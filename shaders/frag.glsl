@@ -6,8 +6,20 @@ layout(location = 1) in vec2 fragTexCoord;
 
 layout(location = 0) out vec4 outColor;
 
-layout(binding = 1) uniform sampler2D texSampler;
+// Every texture of the scene, or a group of them when the device limits how many samplers a stage can see
+layout(constant_id = 0) const uint TEXTURE_SLOTS = 1;
+layout(binding = 1) uniform sampler2D texSamplers[TEXTURE_SLOTS];
+
+// Pipeline variant, see graphics::PipelineVariant: folded away by the driver rather than branched on per fragment
+layout(constant_id = 1) const bool TEXTURED = true;
+
+// Same for the whole draw, so dynamically uniform: no need for descriptor indexing's nonuniformEXT
+layout(push_constant) uniform Draw {
+	uint textureSlot;
+} draw;
 
 void main() {
-	outColor = texture(texSampler, fragTexCoord);
+	outColor = vec4(fragColor, 1.0);
+	if (TEXTURED)
+		outColor *= texture(texSamplers[draw.textureSlot], fragTexCoord);
 }
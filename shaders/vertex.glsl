@@ -4,18 +4,31 @@
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
+// Placement of the copy of the object drawn, see graphics::SceneObject
+layout(location = 3) in mat4 inInstance;
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
 
-layout(binding = 0) uniform UniformBufferObject {
+// See graphics::FrameUniforms, the projection is premultiplied with the view on the CPU
+layout(binding = 0) uniform Frame {
+	mat4 viewProj;
+} frame;
+
+#ifndef GPU_DRIVEN
+// See graphics::ObjectUniforms, bound at the offset of the draw's object
+layout(binding = 2) uniform Object {
 	mat4 model;
-	mat4 view;
-	mat4 proj;
-} ubo;
+} object;
+#endif
 
 void main() {
-	gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+#ifdef GPU_DRIVEN
+	// Culling already placed the instance with its object, see shaders/cull.glsl
+	gl_Position = frame.viewProj * inInstance * vec4(inPosition, 1.0);
+#else
+	gl_Position = frame.viewProj * object.model * inInstance * vec4(inPosition, 1.0);
+#endif
 	fragColor = inColor;
 	fragTexCoord = inTexCoord;
 }
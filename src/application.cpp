@@ -1,13 +1,21 @@
 #include "application.h"
 
+#include "assets/png.h"
 #include "graphics/queue_families.h"
 #include "graphics/swap_chain.h"
 #include "graphics/utils.h"
-#include "parser/parser.h"
 
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <map>
+#include <optional>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 static void key_input(GLFWwindow *window, const int key, const int /*scancode*/, const int action, const int /*mods*/) {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
@@ -20,18 +28,146 @@ static void framebufferResized(GLFWwindow *window, const int, const int) {
 	app->mark_framebuffer_resized();
 }
 
-Application::Application(const int ac, char **av) : _window(nullptr), _physicalDevice(VK_NULL_HANDLE) {
-	if (ac != 2) {
-		std::cerr << "usage: ./scop <scene file>" << std::endl;
-		std::exit(1);
+template <typename T>
+static bool parse_number(const std::string_view str, T &value) {
+	const auto [end, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+	return ec == std::errc{} && end == str.data() + str.size();
+}
+
+static void usage() {
+	std::cerr << "usage: ./scop [--mips gpu|box|kaiser] [--texture-budget <MiB>] [--profile <file>] [--headless <png> [--frames <n>] [--size <w>x<h>]]\n"
+				 "              [--record-once] [--grid <x>x<y>[x<z>]] [--gpu-driven [--occlusion]] [--in-flight <n>] [--images <n>]\n"
+				 "              [--present-mode immediate|mailbox|fifo|fifo-relaxed] [--pacing throughput|latency] <model file>...\n"
+				 "  --mips            where texture mip chains are built: on the GPU by blitting, or on the CPU with a box (default) or Kaiser filter\n"
+				 "  --texture-budget  GPU memory textures may stream their larger mip levels into, 256 MiB by default\n"
+				 "  --profile         file the timings of the last frames are written to on exit, as JSON if it ends in .json and CSV otherwise\n"
+				 "  --headless        render offscreen without a window and write the last frame to the given PNG\n"
+				 "  --frames          frames rendered headless, 1 by default, more being rendered while textures are still streaming in\n"
+				 "  --size            size of headless renders, " << WINDOW_WIDTH << "x" << WINDOW_HEIGHT << " by default\n"
+				 "  --record-once     record command buffers once and submit them again as long as the scene doesn't change, for static displays\n"
+				 "  --grid            copies of every model laid out on a grid, all drawn at once with instancing\n"
+				 "  --gpu-driven      cull instances in a compute pass writing indirect draws, instead of on the CPU every frame\n"
+				 "  --occlusion       with --gpu-driven, also skip instances hidden behind what was drawn last frame\n"
+				 "  --in-flight       frames recorded ahead of the GPU, " << graphics::DEFAULT_FRAMES_IN_FLIGHT << " by default\n"
+				 "  --images          swapchain images, clamped to what the surface supports, one more than its minimum by default\n"
+				 "  --present-mode    mailbox when available and fifo otherwise by default, falling back to those when unsupported\n"
+				 "  --pacing          throughput (default) keeps every frame in flight busy, latency waits for the GPU to be done and\n"
+				 "                    samples input right before recording each frame"
+			  << std::endl;
+	std::exit(1);
+}
+
+Application::Options Application::parse_options(const int ac, char **av) {
+	Options res;
+
+	for (int i = 1; i < ac; i++) {
+		const std::string_view arg = av[i];
+		if (arg == "--record-once") {
+			res.recordOnce = true;
+			continue;
+		}
+		if (arg == "--gpu-driven") {
+			res.gpuDriven = true;
+			continue;
+		}
+		if (arg == "--occlusion") {
+			res.gpuDriven		 = true;
+			res.occlusionCulling = true;
+			continue;
+		}
+		if (arg != "--mips" && arg != "--texture-budget" && arg != "--profile" && arg != "--headless" && arg != "--frames" && arg != "--size" && arg != "--grid" &&
+			arg != "--in-flight" && arg != "--images" && arg != "--present-mode" && arg != "--pacing") {
+			res.models.emplace_back(arg);
+			continue;
+		}
+		if (i + 1 >= ac)
+			usage();
+
+		const std::string_view value = av[++i];
+		if (arg == "--profile") {
+			res.profileOutput = std::string(value);
+		} else if (arg == "--headless") {
+			res.headlessOutput = std::string(value);
+		} else if (arg == "--frames") {
+			if (!parse_number(value, res.frames) || res.frames == 0)
+				usage();
+		} else if (arg == "--in-flight") {
+			if (!parse_number(value, res.framesInFlight) || res.framesInFlight == 0)
+				usage();
+		} else if (arg == "--images") {
+			uint32_t count = 0;
+			if (!parse_number(value, count) || count == 0)
+				usage();
+			res.swapchainImages = count;
+		} else if (arg == "--present-mode") {
+			res.presentMode = graphics::parse_present_mode(value);
+			if (!res.presentMode)
+				usage();
+		} else if (arg == "--pacing") {
+			if (value == "throughput")
+				res.pacing = graphics::FramePacing::THROUGHPUT;
+			else if (value == "latency")
+				res.pacing = graphics::FramePacing::LATENCY;
+			else
+				usage();
+		} else if (arg == "--size") {
+			const auto x = value.find('x');
+			if (x == std::string_view::npos || !parse_number(value.substr(0, x), res.size.width) ||
+				!parse_number(value.substr(x + 1), res.size.height) || res.size.width == 0 || res.size.height == 0)
+				usage();
+		} else if (arg == "--grid") {
+			std::string_view rest = value;
+			for (size_t axis = 0; axis < res.grid.size() && !rest.empty(); axis++) {
+				const auto x = rest.find('x');
+				if (!parse_number(rest.substr(0, x), res.grid[axis]) || res.grid[axis] == 0)
+					usage();
+				rest = x == std::string_view::npos ? std::string_view() : rest.substr(x + 1);
+			}
+			if (!rest.empty())
+				usage();
+		} else if (arg == "--texture-budget") {
+			size_t mebibytes = 0;
+			if (std::from_chars(value.data(), value.data() + value.size(), mebibytes).ec != std::errc{} || mebibytes == 0)
+				usage();
+			res.textureBudget = mebibytes << 20;
+		} else if (value == "gpu")
+			res.mipFilter = std::nullopt;
+		else if (value == "box")
+			res.mipFilter = assets::MipFilter::Box;
+		else if (value == "kaiser")
+			res.mipFilter = assets::MipFilter::Kaiser;
+		else
+			usage();
 	}
 
-	try {
-		parser::parse(av[1]);
-	} catch (const std::exception &e) {
-		std::cerr << e.what() << std::endl;
-		std::exit(1);
+	if (res.models.empty())
+		usage();
+
+	return res;
+}
+
+Application::Application(const int ac, char **av) : Application(parse_options(ac, av)) {
+}
+
+Application::Application(const Options &options)
+	: _options(options), _loader(std::thread::hardware_concurrency(), assets::TextureCache(), options.mipFilter), _window(nullptr),
+	  _physicalDevice(VK_NULL_HANDLE) {
+	// Meshes and their textures are loaded on the loader's workers and shaders compiled on threads of their own, all
+	// overlapping with window and device creation in init()
+	for (const auto &model : options.models)
+		_meshes.emplace_back(model, _loader.load_mesh(model));
+	// GPU-driven draws get their instances with the object's placement folded in by the culling pass
+	graphics::resources::Shader::Defines vertexDefines;
+	if (options.gpuDriven) {
+		graphics::resources::Shader::Defines cullDefines;
+		if (options.occlusionCulling)
+			cullDefines["OCCLUSION"] = "1";
+		vertexDefines["GPU_DRIVEN"] = "1";
+		_cullShader					= graphics::resources::Shader::compile_async("shaders/cull.glsl", graphics::resources::SpirvCache(), cullDefines);
 	}
+	_vertexShader	= graphics::resources::Shader::compile_async("shaders/vertex.glsl", graphics::resources::SpirvCache(), vertexDefines);
+	_fragmentShader = graphics::resources::Shader::compile_async("shaders/frag.glsl", graphics::resources::SpirvCache());
+
 	init();
 }
 
@@ -45,30 +181,152 @@ Application::~Application() {
 
 
 void Application::init() {
-	init_window();
-	_instance = std::make_unique<graphics::VulkanInstance>();
+	std::optional<VkExtent2D> offscreen;
+	if (_options.headlessOutput)
+		offscreen = _options.size;
+	else
+		init_window();
+
+	_instance = std::make_unique<graphics::VulkanInstance>(offscreen);
 	_instance->set_renderer(_instance.get(), _window.get());
 	select_physical_device();
-	_instance->set_msaa_samples(graphics::get_max_usable_sample_count(_physicalDevice));
+	// Occlusion culling samples the depth buffer, which some devices allow at fewer samples than they render with
+	const VkSampleCountFlagBits samples = graphics::get_max_usable_sample_count(_physicalDevice, _options.occlusionCulling);
+	if (const auto rendered = graphics::get_max_usable_sample_count(_physicalDevice); samples != rendered)
+		std::cerr << "warning: " << rendered << "x MSAA lowered to " << samples << "x, the most depth can be sampled at for --occlusion" << std::endl;
+	_instance->set_msaa_samples(samples);
+	// The pyramid's first level reads every sample of the depth buffer, whose count is only known now
+	if (_options.occlusionCulling)
+		_pyramidShader = graphics::resources::Shader::compile_async("shaders/depth_pyramid.glsl", graphics::resources::SpirvCache(),
+																	{{"SAMPLES", std::to_string(static_cast<uint32_t>(samples))}});
+	_instance->set_texture_budget(_options.textureBudget);
+	_instance->set_record_once(_options.recordOnce);
+	_instance->set_occlusion_culling(_options.occlusionCulling);
+	_instance->set_frames_in_flight(_options.framesInFlight);
+	_instance->set_present_mode(_options.presentMode);
+	_instance->set_swapchain_images(_options.swapchainImages);
+	_instance->set_frame_pacing(_options.pacing);
 	_instance->create_device(_physicalDevice);
 	_instance->create_swapchain(_physicalDevice);
 	_instance->create_image_views();
-	_instance->create_pipeline(_physicalDevice, "shaders/vertex.glsl", "shaders/frag.glsl");
 	_instance->create_command_pool(_physicalDevice);
 	_instance->create_short_lived_command_pool(_physicalDevice);
+
+	auto [scene, objects]			  = collect_geometry();
+	auto [textures, materialTextures] = collect_textures(scene);
+	_instance->create_texture_objects(_physicalDevice, textures);
+	_instance->create_tex_img_views();
+	_instance->create_tex_sampler(_physicalDevice);
+
+	_instance->create_pipeline(_physicalDevice, _vertexShader.get(), _fragmentShader.get());
+	if (_options.gpuDriven)
+		_instance->create_cull_pipeline(_physicalDevice, _cullShader.get());
+	if (_options.occlusionCulling)
+		_instance->create_pyramid_pipeline(_pyramidShader.get());
+	if (!_instance->headless())
+		_instance->watch_shaders();
 	_instance->create_color_resources(_physicalDevice);
 	_instance->create_depth_img(_physicalDevice);
 	_instance->create_framebuffers();
-	_instance->create_texture_object(_physicalDevice, "resources/textures/viking_room.png");
-	_instance->create_tex_img_view();
-	_instance->create_tex_sampler(_physicalDevice);
+	_instance->set_geometry(std::move(scene), materialTextures, std::move(objects));
 	_instance->create_vertex_buffer(_physicalDevice);
 	_instance->create_index_buffer(_physicalDevice);
+	_instance->create_instance_buffer(_physicalDevice);
+	if (_options.gpuDriven)
+		_instance->create_cull_buffers(_physicalDevice);
 	_instance->create_uniform_buffers(_physicalDevice);
 	_instance->create_descriptor_pool();
 	_instance->create_descriptor_sets();
 	_instance->create_command_buffers();
 	_instance->create_sync_objects();
+	_instance->create_gpu_profiler(_physicalDevice);
+}
+
+
+std::pair<geometry::Mesh, std::vector<graphics::SceneObject>> Application::collect_geometry() {
+	geometry::Mesh					 scene;
+	std::vector<graphics::SceneObject> objects;
+
+	for (auto &[path, future] : _meshes) {
+		const auto firstSubmesh = static_cast<uint32_t>(scene.submeshes.size());
+		const auto firstVertex	= scene.vertices.size();
+		try {
+			scene.append(future.get());
+		} catch (const std::exception &e) {
+			throw std::runtime_error(path + ": " + e.what());
+		}
+		objects.push_back({firstSubmesh, static_cast<uint32_t>(scene.submeshes.size()) - firstSubmesh});
+		objects.back().instances = grid_instances(std::span(scene.vertices).subspan(firstVertex));
+	}
+	_meshes.clear();
+
+	return {std::move(scene), std::move(objects)};
+}
+
+
+std::vector<maths::Mat4> Application::grid_instances(const std::span<const geometry::Vertex> vertices) const {
+	const auto &[nx, ny, nz] = _options.grid;
+	if (vertices.empty() || nx * ny * nz == 1)
+		return {maths::Mat4::identity};
+
+	// Copies are a box and a half apart, the grid centered on where the model was
+	maths::Vec3 low = vertices.front().position, high = low;
+	for (const auto &vertex : vertices) {
+		const auto &p = vertex.position;
+		low			  = maths::Vec3(std::min(low.x(), p.x()), std::min(low.y(), p.y()), std::min(low.z(), p.z()));
+		high		  = maths::Vec3(std::max(high.x(), p.x()), std::max(high.y(), p.y()), std::max(high.z(), p.z()));
+	}
+	const auto spacing = (high - low) * 1.5f;
+
+	std::vector<maths::Mat4> instances;
+	instances.reserve(static_cast<size_t>(nx) * ny * nz);
+	for (uint32_t z = 0; z < nz; z++) {
+		for (uint32_t y = 0; y < ny; y++) {
+			for (uint32_t x = 0; x < nx; x++) {
+				const maths::Vec3 offset((x - (nx - 1) * 0.5f) * spacing.x(), (y - (ny - 1) * 0.5f) * spacing.y(), (z - (nz - 1) * 0.5f) * spacing.z());
+				instances.push_back(maths::Mat4::translate(offset));
+			}
+		}
+	}
+	return instances;
+}
+
+
+std::pair<std::vector<graphics::resources::Texture>, std::vector<std::optional<uint32_t>>> Application::collect_textures(const geometry::Mesh &scene) {
+	std::vector<graphics::resources::Texture> textures;
+	std::vector<std::optional<uint32_t>>	  materialTextures;
+	std::map<const uint8_t *, uint32_t>		  indices;
+
+	auto add = [&](graphics::resources::Texture texture) {
+		const auto [it, inserted] = indices.try_emplace(texture.pixels.get(), static_cast<uint32_t>(textures.size()));
+		if (inserted)
+			textures.push_back(std::move(texture));
+		return it->second;
+	};
+
+	for (const auto &material : scene.materials) {
+		graphics::resources::Texture texture;
+
+		// Already decoding since load_mesh, the loader hands back the same pixels for every material sharing a map
+		if (material.diffuse_map) {
+			texture = _loader.load_texture(*material.diffuse_map).get();
+			if (texture && !graphics::VulkanInstance::supports_texture_format(_physicalDevice, texture.format)) {
+				std::cerr << "warning: compressed texture for " << *material.diffuse_map << " isn't supported by the device, decoding it instead" << std::endl;
+				texture = _loader.load_texture(*material.diffuse_map, false).get();
+			}
+			if (!texture)
+				std::cerr << "warning: couldn't load " << *material.diffuse_map << ", using material color only" << std::endl;
+		}
+
+		// Untextured materials get a pipeline variant that doesn't sample at all
+		materialTextures.push_back(texture ? std::optional(add(std::move(texture))) : std::nullopt);
+	}
+
+	// Descriptor sets still need an image to point at
+	if (textures.empty())
+		add(graphics::resources::Texture::solid(255, 255, 255));
+
+	return {std::move(textures), std::move(materialTextures)};
 }
 
 
@@ -87,21 +345,31 @@ void Application::init_window() {
 
 
 int Application::run() const {
+	if (_instance->headless())
+		return run_headless();
+
 	uint64_t		   frame_cnt			  = 0;
 	uint32_t		   frame_idx			  = 0;
 	double			   time_since_last_update = glfwGetTime();
 
 	std::ostringstream oss;
 
+	// Events are polled by the renderer, when depends on its pacing
 	while (!glfwWindowShouldClose(_window.get())) {
-		glfwPollEvents();
 		_instance->render(_physicalDevice, frame_idx);
 		frame_cnt++;
-		frame_idx = (frame_idx + 1) % MAX_FRAMES_IN_FLIGHT;
+		frame_idx = (frame_idx + 1) % _options.framesInFlight;
 
 		if (glfwGetTime() - time_since_last_update >= 1.0) {
+			const auto &profiler = _instance->profiler();
 			oss.str("");
-			oss << WINDOW_TITLE << " - FPS: " << frame_cnt;
+			oss << WINDOW_TITLE << " - FPS: " << frame_cnt << std::fixed << std::setprecision(2);
+			if (const auto frame = profiler.percentiles(graphics::FrameProfiler::Scope::FRAME))
+				oss << " - frame p50/p95/p99: " << frame->p50 << '/' << frame->p95 << '/' << frame->p99 << " ms";
+			if (const auto pass = profiler.percentiles(graphics::FrameProfiler::Scope::GPU_RENDER_PASS))
+				oss << " - GPU render pass: " << pass->p50 << " ms";
+			if (const auto upload = profiler.percentiles(graphics::FrameProfiler::Scope::GPU_UPLOAD))
+				oss << ", uploads: " << upload->p50 << " ms";
 
 			glfwSetWindowTitle(_window.get(), oss.str().c_str());
 			time_since_last_update = glfwGetTime();
@@ -110,10 +378,50 @@ int Application::run() const {
 	}
 
 	_instance->waitIdle();
+	write_profile();
 
 	return 0;
 }
 
+int Application::run_headless() const {
+	// Past the requested frames, rendering goes on until every texture is sharp, or gives up after that many more
+	constexpr uint32_t MAX_STREAMING_FRAMES = 1000;
+
+	uint32_t		   frame_idx			= 0;
+	uint32_t		   frame				= 0;
+	for (; frame < _options.frames || (!_instance->textures_settled() && frame < _options.frames + MAX_STREAMING_FRAMES); frame++) {
+		_instance->render(_physicalDevice, frame_idx);
+		frame_idx = (frame_idx + 1) % _options.framesInFlight;
+	}
+	if (!_instance->textures_settled())
+		std::cerr << "warning: textures still streaming after " << frame << " frames" << std::endl;
+
+	const uint32_t last	  = (frame_idx + _options.framesInFlight - 1) % _options.framesInFlight;
+	const auto	   pixels = _instance->read_back(_physicalDevice, last);
+	assets::png::write(*_options.headlessOutput, _options.size.width, _options.size.height, pixels);
+	std::cerr << "Rendered " << frame << " frames, the last one written to " << *_options.headlessOutput << std::endl;
+
+	write_profile();
+	return 0;
+}
+
+void Application::write_profile() const {
+	if (!_options.profileOutput)
+		return;
+
+	const auto	 &path = *_options.profileOutput;
+	std::ofstream ofs(path);
+	if (path.ends_with(".json"))
+		_instance->profiler().write_json(ofs);
+	else
+		_instance->profiler().write_csv(ofs);
+
+	if (!ofs)
+		std::cerr << "warning: couldn't write the profile to " << path << std::endl;
+	else
+		std::cerr << "Frame timings written to " << path << std::endl;
+}
+
 void Application::mark_framebuffer_resized() const {
 	_instance->mark_framebuffer_resized();
 }
@@ -161,15 +469,26 @@ uint32_t Application::check_physical_device_suitability(VkPhysicalDevice physica
 }
 
 
-bool Application::check_mandatory_features(VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties, VkPhysicalDeviceFeatures deviceFeatures) const {
-	if (!deviceFeatures.sampleRateShading || !deviceFeatures.samplerAnisotropy)
+bool Application::check_mandatory_features(VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties deviceProperties,
+										   VkPhysicalDeviceFeatures deviceFeatures) const {
+	// Dynamic indexing: draws pick their texture out of the sampler array with a push constant
+	if (!deviceFeatures.sampleRateShading || !deviceFeatures.samplerAnisotropy || !deviceFeatures.shaderSampledImageArrayDynamicIndexing)
+		return false;
+	// Every indirect command but the first starts at a non-zero firstInstance
+	if (_options.gpuDriven && !deviceFeatures.drawIndirectFirstInstance) {
+		std::cerr << "Device `" << deviceProperties.deviceName << "` lacks drawIndirectFirstInstance, needed by --gpu-driven" << std::endl;
 		return false;
+	}
 
-	auto surface			= _instance->get_surface();
+	// Headless, there is no surface: nothing to present to, nor swapchain extension to require
+	const bool headless			  = _instance->headless();
+	auto	   surface			  = _instance->get_surface();
 
-	bool extensionSupported = graphics::check_device_extension_support(physicalDevice);
-	auto queueFamilies		= graphics::find_queue_families(physicalDevice, surface);
-	auto swapChainSupport	= graphics::query_swap_chain_support(physicalDevice, surface);
+	bool	   extensionSupported = graphics::check_device_extension_support(physicalDevice, headless);
+	auto	   queueFamilies	  = graphics::find_queue_families(physicalDevice, surface);
+	bool	   swapChainSupport	  = headless || static_cast<bool>(graphics::query_swap_chain_support(physicalDevice, surface));
+	// The culling pass is recorded in the same command buffers as the draws it feeds
+	bool	   computeSupport	  = !_options.gpuDriven || (queueFamilies.computeFamily && queueFamilies.computeFamily == queueFamilies.graphicsFamily);
 
-	return queueFamilies && extensionSupported && swapChainSupport;
+	return queueFamilies && extensionSupported && swapChainSupport && computeSupport;
 }
@@ -0,0 +1,328 @@
+#include "assets/block_compression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+#include <stdexcept>
+
+namespace assets::bc {
+
+namespace {
+
+using graphics::resources::Texture;
+
+// 4x4 RGBA texels, row major
+using Block = std::array<std::array<uint8_t, 4>, 16>;
+template <size_t N>
+using Color = std::array<float, N>;
+
+Block fetch_block(const uint8_t *pixels, const size_t w, const size_t h, const size_t bx, const size_t by) {
+	Block block;
+
+	for (size_t y = 0; y < 4; y++) {
+		for (size_t x = 0; x < 4; x++) {
+			// Partial blocks on the right and bottom edges repeat the last texel
+			const size_t sx = std::min(bx * 4 + x, w - 1);
+			const size_t sy = std::min(by * 4 + y, h - 1);
+			std::copy_n(pixels + (sy * w + sx) * 4, 4, block[y * 4 + x].begin());
+		}
+	}
+
+	return block;
+}
+
+template <size_t N>
+float distance2(const Color<N> &a, const std::array<uint8_t, 4> &b) {
+	float res = 0.0f;
+	for (size_t c = 0; c < N; c++)
+		res += (a[c] - b[c]) * (a[c] - b[c]);
+	return res;
+}
+
+// Extremities of the block's first N channels along their principal axis, found by power iteration on the covariance
+template <size_t N>
+std::pair<Color<N>, Color<N>> principal_endpoints(const Block &block) {
+	Color<N> mean{};
+	for (const auto &texel : block)
+		for (size_t c = 0; c < N; c++)
+			mean[c] += texel[c] / 16.0f;
+
+	std::array<float, N * N> cov{};
+	for (const auto &texel : block)
+		for (size_t i = 0; i < N; i++)
+			for (size_t j = 0; j < N; j++)
+				cov[i * N + j] += (texel[i] - mean[i]) * (texel[j] - mean[j]);
+
+	Color<N> axis;
+	axis.fill(1.0f);
+	for (int iteration = 0; iteration < 8; iteration++) {
+		Color<N> next{};
+		for (size_t i = 0; i < N; i++)
+			for (size_t j = 0; j < N; j++)
+				next[i] += cov[i * N + j] * axis[j];
+
+		const float len = std::abs(*std::ranges::max_element(next, {}, [](float v) { return std::abs(v); }));
+		// Flat block: any axis works
+		if (len < 1e-6f)
+			break;
+		for (size_t i = 0; i < N; i++)
+			axis[i] = next[i] / len;
+	}
+
+	float lo = 0.0f, hi = 0.0f;
+	for (const auto &texel : block) {
+		float t = 0.0f;
+		for (size_t c = 0; c < N; c++)
+			t += (texel[c] - mean[c]) * axis[c];
+		lo = std::min(lo, t);
+		hi = std::max(hi, t);
+	}
+
+	Color<N> e0, e1;
+	for (size_t c = 0; c < N; c++) {
+		e0[c] = std::clamp(mean[c] + axis[c] * lo, 0.0f, 255.0f);
+		e1[c] = std::clamp(mean[c] + axis[c] * hi, 0.0f, 255.0f);
+	}
+
+	return {e0, e1};
+}
+
+uint16_t to_565(const Color<3> &c) {
+	const auto r = static_cast<uint16_t>(std::lround(c[0] * 31.0f / 255.0f));
+	const auto g = static_cast<uint16_t>(std::lround(c[1] * 63.0f / 255.0f));
+	const auto b = static_cast<uint16_t>(std::lround(c[2] * 31.0f / 255.0f));
+	return static_cast<uint16_t>(r << 11 | g << 5 | b);
+}
+
+Color<3> from_565(const uint16_t v) {
+	const unsigned r = v >> 11 & 31, g = v >> 5 & 63, b = v & 31;
+	return {static_cast<float>(r << 3 | r >> 2), static_cast<float>(g << 2 | g >> 4), static_cast<float>(b << 3 | b >> 2)};
+}
+
+void encode_bc1(const Block &block, uint8_t *out) {
+	const bool transparent = std::ranges::any_of(block, [](const auto &texel) { return texel[3] < 128; });
+	const auto [lo, hi]	   = principal_endpoints<3>(block);
+
+	uint16_t   c0 = to_565(hi), c1 = to_565(lo);
+	// c0 > c1 selects the opaque 4-color mode, c0 <= c1 the 3-color one with a transparent index
+	if (transparent ? c0 > c1 : c0 < c1)
+		std::swap(c0, c1);
+
+	std::array<Color<3>, 4> palette{from_565(c0), from_565(c1)};
+	for (size_t c = 0; c < 3; c++) {
+		if (c0 > c1) {
+			palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+			palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+		} else {
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2.0f;
+		}
+	}
+	const size_t candidates = c0 > c1 ? 4 : 3;
+
+	uint32_t	 indices	= 0;
+	for (size_t i = 0; i < block.size(); i++) {
+		uint32_t best = 3;
+		if (!transparent || block[i][3] >= 128) {
+			best = 0;
+			for (uint32_t p = 1; p < candidates; p++)
+				if (distance2(palette[p], block[i]) < distance2(palette[best], block[i]))
+					best = p;
+		}
+		indices |= best << (2 * i);
+	}
+
+	out[0] = static_cast<uint8_t>(c0);
+	out[1] = static_cast<uint8_t>(c0 >> 8);
+	out[2] = static_cast<uint8_t>(c1);
+	out[3] = static_cast<uint8_t>(c1 >> 8);
+	for (size_t i = 0; i < 4; i++)
+		out[4 + i] = static_cast<uint8_t>(indices >> (8 * i));
+}
+
+constexpr std::array<uint32_t, 16> BC7_WEIGHTS{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// Mode 6 endpoint: 7 bits per channel plus a p-bit shared by the 4 channels
+struct Bc7Endpoint {
+	std::array<uint8_t, 4> q;
+	uint8_t				   p;
+
+	[[nodiscard]] std::array<uint8_t, 4> value() const {
+		return {static_cast<uint8_t>(q[0] << 1 | p), static_cast<uint8_t>(q[1] << 1 | p), static_cast<uint8_t>(q[2] << 1 | p), static_cast<uint8_t>(q[3] << 1 | p)};
+	}
+
+	static Bc7Endpoint quantize(const Color<4> &c) {
+		Bc7Endpoint best{};
+		float		bestError = INFINITY;
+
+		for (uint8_t p = 0; p < 2; p++) {
+			Bc7Endpoint candidate{{}, p};
+			float		error = 0.0f;
+			for (size_t i = 0; i < 4; i++) {
+				candidate.q[i]	   = static_cast<uint8_t>(std::clamp(std::lround((c[i] - p) / 2.0f), 0L, 127L));
+				const float actual = static_cast<float>(candidate.q[i] << 1 | p);
+				error			  += (actual - c[i]) * (actual - c[i]);
+			}
+			if (error < bestError) {
+				best	  = candidate;
+				bestError = error;
+			}
+		}
+
+		return best;
+	}
+};
+
+struct Bc7Fit {
+	Bc7Endpoint				 e0, e1;
+	std::array<uint8_t, 16> indices;
+	float					 error;
+};
+
+Bc7Fit bc7_fit(const Block &block, const Color<4> &lo, const Color<4> &hi) {
+	Bc7Fit	   fit{Bc7Endpoint::quantize(lo), Bc7Endpoint::quantize(hi), {}, 0.0f};
+
+	const auto a = fit.e0.value(), b = fit.e1.value();
+	std::array<Color<4>, 16> palette;
+	for (size_t w = 0; w < palette.size(); w++)
+		for (size_t c = 0; c < 4; c++)
+			palette[w][c] = static_cast<float>(((64 - BC7_WEIGHTS[w]) * a[c] + BC7_WEIGHTS[w] * b[c] + 32) >> 6);
+
+	for (size_t i = 0; i < block.size(); i++) {
+		uint8_t best = 0;
+		for (uint8_t w = 1; w < palette.size(); w++)
+			if (distance2(palette[w], block[i]) < distance2(palette[best], block[i]))
+				best = w;
+		fit.indices[i]	= best;
+		fit.error	   += distance2(palette[best], block[i]);
+	}
+
+	return fit;
+}
+
+// Endpoints minimizing the squared error for the weights picked by `fit`
+std::optional<std::pair<Color<4>, Color<4>>> bc7_least_squares(const Block &block, const Bc7Fit &fit) {
+	float	 aa = 0.0f, ab = 0.0f, bb = 0.0f;
+	Color<4> ax{}, bx{};
+
+	for (size_t i = 0; i < block.size(); i++) {
+		const float t  = BC7_WEIGHTS[fit.indices[i]] / 64.0f;
+		aa			  += (1.0f - t) * (1.0f - t);
+		ab			  += (1.0f - t) * t;
+		bb			  += t * t;
+		for (size_t c = 0; c < 4; c++) {
+			ax[c] += (1.0f - t) * block[i][c];
+			bx[c] += t * block[i][c];
+		}
+	}
+
+	const float det = aa * bb - ab * ab;
+	if (std::abs(det) < 1e-6f)
+		return std::nullopt;
+
+	Color<4> lo, hi;
+	for (size_t c = 0; c < 4; c++) {
+		lo[c] = std::clamp((bb * ax[c] - ab * bx[c]) / det, 0.0f, 255.0f);
+		hi[c] = std::clamp((aa * bx[c] - ab * ax[c]) / det, 0.0f, 255.0f);
+	}
+
+	return std::pair{lo, hi};
+}
+
+class BitWriter {
+public:
+	explicit BitWriter(uint8_t *out) : _out(out) {
+		std::fill_n(_out, 16, 0);
+	}
+
+	void put(const uint32_t value, const size_t bits) {
+		for (size_t b = 0; b < bits; b++, _pos++)
+			_out[_pos / 8] |= static_cast<uint8_t>((value >> b & 1) << (_pos % 8));
+	}
+
+private:
+	uint8_t *_out;
+	size_t	 _pos{0};
+};
+
+void encode_bc7(const Block &block, uint8_t *out) {
+	const auto [lo, hi] = principal_endpoints<4>(block);
+	auto fit			= bc7_fit(block, lo, hi);
+
+	if (const auto refinedEndpoints = fit.error > 0.0f ? bc7_least_squares(block, fit) : std::nullopt) {
+		if (auto refined = bc7_fit(block, refinedEndpoints->first, refinedEndpoints->second); refined.error < fit.error)
+			fit = refined;
+	}
+
+	// The first index is stored without its high bit, which must therefore be 0
+	if (fit.indices[0] & 8) {
+		std::swap(fit.e0, fit.e1);
+		for (auto &index : fit.indices)
+			index = static_cast<uint8_t>(15 - index);
+	}
+
+	BitWriter writer(out);
+	writer.put(1 << 6, 7); // mode 6
+	for (size_t c = 0; c < 4; c++) {
+		writer.put(fit.e0.q[c], 7);
+		writer.put(fit.e1.q[c], 7);
+	}
+	writer.put(fit.e0.p, 1);
+	writer.put(fit.e1.p, 1);
+	writer.put(fit.indices[0], 3);
+	for (size_t i = 1; i < fit.indices.size(); i++)
+		writer.put(fit.indices[i], 4);
+}
+
+void encode_row(const Texture &source, Texture &res, const uint32_t level, const size_t by) {
+	const size_t   w		  = source.level_width(level);
+	const size_t   h		  = source.level_height(level);
+	const size_t   blocksX	  = (w + 3) / 4;
+	const size_t   blockBytes = Texture::block_bytes(res.format);
+
+	const uint8_t *src		  = source.pixels.get() + source.level_offset(level);
+	uint8_t		  *dst		  = res.pixels.get() + res.level_offset(level) + by * blocksX * blockBytes;
+
+	for (size_t bx = 0; bx < blocksX; bx++, dst += blockBytes) {
+		const auto block = fetch_block(src, w, h, bx, by);
+		if (res.format == Texture::Format::BC1_RGBA_SRGB)
+			encode_bc1(block, dst);
+		else
+			encode_bc7(block, dst);
+	}
+}
+
+} // namespace
+
+Texture compress(const Texture &source, const Texture::Format format, ThreadPool *pool) {
+	if (!source || source.compressed())
+		throw std::invalid_argument("only RGBA8 textures can be block compressed");
+	if (format == Texture::Format::RGBA8_SRGB)
+		return source;
+
+	Texture res{
+		.pixels	  = nullptr,
+		.w		  = source.w,
+		.h		  = source.h,
+		.channels = source.channels,
+		.levels	  = source.levels,
+		.format	  = format,
+	};
+	res.pixels = std::shared_ptr<uint8_t>(new uint8_t[res.device_size()], std::default_delete<uint8_t[]>());
+
+	std::vector<std::pair<uint32_t, size_t>> rows;
+	for (uint32_t level = 0; level < res.levels; level++)
+		for (size_t by = 0; by < (res.level_height(level) + 3) / 4; by++)
+			rows.emplace_back(level, by);
+
+	const auto encode = [&](const size_t i) { encode_row(source, res, rows[i].first, rows[i].second); };
+	if (pool)
+		pool->parallel_for(rows.size(), encode);
+	else
+		for (size_t i = 0; i < rows.size(); i++)
+			encode(i);
+
+	return res;
+}
+
+} // namespace assets::bc
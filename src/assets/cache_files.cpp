@@ -0,0 +1,68 @@
+#include "assets/cache_files.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace assets::cache_files {
+
+std::filesystem::path default_directory(const std::string_view name) {
+	if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+		return std::filesystem::path(xdg) / "scop" / name;
+	if (const char *home = std::getenv("HOME"); home && *home)
+		return std::filesystem::path(home) / ".cache" / "scop" / name;
+
+	return {};
+}
+
+bool write(const std::filesystem::path &path, const std::string_view what, const std::function<void(std::ostream &)> &contents) {
+	const auto		directory = path.parent_path();
+
+	std::error_code ec;
+	std::filesystem::create_directories(directory, ec);
+	if (ec) {
+		std::cerr << "warning: couldn't create " << directory << " for " << what << ": " << ec.message() << std::endl;
+		return false;
+	}
+
+	// Unique to the thread as well as the time, several workers may write the same file at once
+	std::ostringstream tmpName;
+	tmpName << path.filename().string() << ".tmp." << std::hash<std::thread::id>{}(std::this_thread::get_id()) << '.'
+			<< std::chrono::steady_clock::now().time_since_epoch().count();
+	const auto tmp = directory / tmpName.str();
+
+	{
+		std::ofstream ofs(tmp, std::ios::binary);
+		contents(ofs);
+
+		if (!ofs) {
+			std::cerr << "warning: couldn't write " << what << " " << tmp << std::endl;
+			ofs.close();
+			std::filesystem::remove(tmp, ec);
+			return false;
+		}
+	}
+
+	std::filesystem::rename(tmp, path, ec);
+	if (ec) {
+		std::cerr << "warning: couldn't write " << what << " " << path << ": " << ec.message() << std::endl;
+		std::filesystem::remove(tmp, ec);
+		return false;
+	}
+	return true;
+}
+
+uint64_t remaining(std::istream &is) {
+	const auto position = is.tellg();
+	if (position < 0 || !is.seekg(0, std::ios::end))
+		return 0;
+
+	const auto end = is.tellg();
+	is.seekg(position);
+	return end < position ? 0 : static_cast<uint64_t>(end - position);
+}
+
+} // namespace assets::cache_files
@@ -0,0 +1,235 @@
+#include "assets/ktx2.h"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace assets::ktx2 {
+
+namespace {
+
+using graphics::resources::Texture;
+
+constexpr std::array<uint8_t, 12> IDENTIFIER{0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+// VkFormat values, spelled out so that the core library doesn't depend on the Vulkan headers
+constexpr uint32_t				  VK_FORMAT_R8G8B8A8_SRGB	   = 43;
+constexpr uint32_t				  VK_FORMAT_BC1_RGBA_SRGB_BLOCK = 134;
+constexpr uint32_t				  VK_FORMAT_BC7_SRGB_BLOCK	   = 146;
+
+// Data Format Descriptor constants (Khronos Data Format Specification 1.3)
+constexpr uint8_t				  KHR_DF_MODEL_RGBSDA		   = 1;
+constexpr uint8_t				  KHR_DF_MODEL_BC1A			   = 128;
+constexpr uint8_t				  KHR_DF_MODEL_BC7			   = 134;
+constexpr uint8_t				  KHR_DF_PRIMARIES_BT709	   = 1;
+constexpr uint8_t				  KHR_DF_TRANSFER_SRGB		   = 2;
+constexpr uint8_t				  KHR_DF_SAMPLE_DATATYPE_LINEAR = 0x10;
+
+#pragma pack(push, 1)
+struct Header {
+	std::array<uint8_t, 12> identifier;
+	uint32_t				vkFormat;
+	uint32_t				typeSize;
+	uint32_t				pixelWidth;
+	uint32_t				pixelHeight;
+	uint32_t				pixelDepth;
+	uint32_t				layerCount;
+	uint32_t				faceCount;
+	uint32_t				levelCount;
+	uint32_t				supercompressionScheme;
+	uint32_t				dfdByteOffset;
+	uint32_t				dfdByteLength;
+	uint32_t				kvdByteOffset;
+	uint32_t				kvdByteLength;
+	uint64_t				sgdByteOffset;
+	uint64_t				sgdByteLength;
+};
+
+struct LevelIndex {
+	uint64_t byteOffset;
+	uint64_t byteLength;
+	uint64_t uncompressedByteLength;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Header) == 80);
+static_assert(sizeof(LevelIndex) == 24);
+
+Texture::Format to_format(const uint32_t vkFormat) {
+	switch (vkFormat) {
+	case VK_FORMAT_R8G8B8A8_SRGB:
+		return Texture::Format::RGBA8_SRGB;
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		return Texture::Format::BC1_RGBA_SRGB;
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		return Texture::Format::BC7_SRGB;
+	default:
+		throw std::runtime_error("unsupported vkFormat " + std::to_string(vkFormat));
+	}
+}
+
+uint32_t to_vk_format(const Texture::Format format) {
+	switch (format) {
+	case Texture::Format::RGBA8_SRGB:
+		return VK_FORMAT_R8G8B8A8_SRGB;
+	case Texture::Format::BC1_RGBA_SRGB:
+		return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+	case Texture::Format::BC7_SRGB:
+		return VK_FORMAT_BC7_SRGB_BLOCK;
+	}
+	throw std::invalid_argument("unknown texture format");
+}
+
+void put_u32(std::vector<uint8_t> &out, const uint32_t value) {
+	for (int i = 0; i < 4; i++)
+		out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+// Basic descriptor block: one sample per channel for RGBA8, a single opaque sample covering the block otherwise
+std::vector<uint8_t> data_format_descriptor(const Texture::Format format) {
+	struct Sample {
+		uint16_t bitOffset;
+		uint8_t	 bitLength;
+		uint8_t	 channelType;
+		uint32_t upper;
+	};
+
+	std::vector<Sample> samples;
+	uint8_t				model	 = 0;
+	uint8_t				blockDim = 0;
+
+	switch (format) {
+	case Texture::Format::RGBA8_SRGB:
+		model	 = KHR_DF_MODEL_RGBSDA;
+		blockDim = 0;
+		samples	 = {{0, 7, 0, 255}, {8, 7, 1, 255}, {16, 7, 2, 255}, {24, 7, 15 | KHR_DF_SAMPLE_DATATYPE_LINEAR, 255}};
+		break;
+	case Texture::Format::BC1_RGBA_SRGB:
+		model	 = KHR_DF_MODEL_BC1A;
+		blockDim = 3;
+		samples	 = {{0, 63, 0, 0xFFFFFFFF}};
+		break;
+	case Texture::Format::BC7_SRGB:
+		model	 = KHR_DF_MODEL_BC7;
+		blockDim = 3;
+		samples	 = {{0, 127, 0, 0xFFFFFFFF}};
+		break;
+	}
+
+	const auto			 blockSize = static_cast<uint32_t>(24 + 16 * samples.size());
+
+	std::vector<uint8_t> dfd;
+	put_u32(dfd, 4 + blockSize);
+	put_u32(dfd, 0);						  // vendorId: Khronos, descriptorType: basic
+	put_u32(dfd, 2 | (blockSize << 16));	  // versionNumber 1.3, descriptorBlockSize
+	dfd.insert(dfd.end(), {model, KHR_DF_PRIMARIES_BT709, KHR_DF_TRANSFER_SRGB, 0});
+	dfd.insert(dfd.end(), {blockDim, blockDim, 0, 0});
+	dfd.push_back(static_cast<uint8_t>(Texture::block_bytes(format)));
+	dfd.insert(dfd.end(), 7, 0);
+	for (const auto &[bitOffset, bitLength, channelType, upper] : samples) {
+		put_u32(dfd, bitOffset | (bitLength << 16) | (channelType << 24));
+		put_u32(dfd, 0); // samplePosition
+		put_u32(dfd, 0); // sampleLower
+		put_u32(dfd, upper);
+	}
+
+	return dfd;
+}
+
+constexpr size_t align(const size_t value, const size_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+Texture read(const std::string &path) {
+	std::ifstream ifs(path, std::ios::binary);
+	if (!ifs)
+		throw std::runtime_error("couldn't open " + path);
+
+	Header header{};
+	if (!ifs.read(reinterpret_cast<char *>(&header), sizeof(header)) || header.identifier != IDENTIFIER)
+		throw std::runtime_error(path + " isn't a KTX2 file");
+	if (header.supercompressionScheme != 0)
+		throw std::runtime_error(path + ": supercompressed KTX2 files aren't supported");
+	if (header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1 || !header.pixelWidth || !header.pixelHeight)
+		throw std::runtime_error(path + ": only single 2D images are supported");
+
+	Texture texture{
+		.pixels	  = nullptr,
+		.w		  = header.pixelWidth,
+		.h		  = header.pixelHeight,
+		.channels = 4UL,
+		// 0 asks the loader to generate mips, which compressed data can't be
+		.levels	  = std::max(header.levelCount, 1U),
+		.format	  = to_format(header.vkFormat),
+	};
+	if (texture.levels > Texture::mip_count(texture.w, texture.h))
+		throw std::runtime_error(path + ": too many mip levels");
+
+	std::vector<LevelIndex> levels(texture.levels);
+	if (!ifs.read(reinterpret_cast<char *>(levels.data()), static_cast<std::streamsize>(levels.size() * sizeof(LevelIndex))))
+		throw std::runtime_error(path + ": truncated level index");
+
+	texture.pixels = std::shared_ptr<uint8_t>(new uint8_t[texture.device_size()], std::default_delete<uint8_t[]>());
+	for (uint32_t level = 0; level < texture.levels; level++) {
+		if (levels[level].byteLength != texture.level_size(level))
+			throw std::runtime_error(path + ": unexpected size for mip level " + std::to_string(level));
+
+		ifs.seekg(static_cast<std::streamoff>(levels[level].byteOffset));
+		if (!ifs.read(reinterpret_cast<char *>(texture.pixels.get() + texture.level_offset(level)), static_cast<std::streamsize>(levels[level].byteLength)))
+			throw std::runtime_error(path + ": truncated mip level " + std::to_string(level));
+	}
+
+	return texture;
+}
+
+void write(const std::string &path, const Texture &texture) {
+	if (!texture)
+		throw std::invalid_argument("can't write an empty texture");
+
+	const auto				dfd		  = data_format_descriptor(texture.format);
+	// Mip data must be aligned on lcm(texel block size, 4)
+	const size_t			alignment = std::max<size_t>(Texture::block_bytes(texture.format), 4);
+
+	Header					header{};
+	header.identifier			  = IDENTIFIER;
+	header.vkFormat				  = to_vk_format(texture.format);
+	header.typeSize				  = 1;
+	header.pixelWidth			  = static_cast<uint32_t>(texture.w);
+	header.pixelHeight			  = static_cast<uint32_t>(texture.h);
+	header.faceCount			  = 1;
+	header.levelCount			  = texture.levels;
+	header.dfdByteOffset		  = static_cast<uint32_t>(sizeof(Header) + texture.levels * sizeof(LevelIndex));
+	header.dfdByteLength		  = static_cast<uint32_t>(dfd.size());
+
+	// Levels are laid out from the smallest to the largest, as the specification recommends for streaming
+	std::vector<LevelIndex> levels(texture.levels);
+	size_t					offset = header.dfdByteOffset + dfd.size();
+	for (uint32_t level = texture.levels; level-- > 0;) {
+		offset		  = align(offset, alignment);
+		levels[level] = {offset, texture.level_size(level), texture.level_size(level)};
+		offset		 += texture.level_size(level);
+	}
+
+	std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+	if (!ofs)
+		throw std::runtime_error("couldn't open " + path + " for writing");
+
+	ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	ofs.write(reinterpret_cast<const char *>(levels.data()), static_cast<std::streamsize>(levels.size() * sizeof(LevelIndex)));
+	ofs.write(reinterpret_cast<const char *>(dfd.data()), static_cast<std::streamsize>(dfd.size()));
+
+	for (uint32_t level = texture.levels; level-- > 0;) {
+		const std::array<char, 16> padding{};
+		ofs.write(padding.data(), static_cast<std::streamsize>(levels[level].byteOffset - static_cast<uint64_t>(ofs.tellp())));
+		ofs.write(reinterpret_cast<const char *>(texture.pixels.get() + texture.level_offset(level)), static_cast<std::streamsize>(levels[level].byteLength));
+	}
+
+	if (!ofs)
+		throw std::runtime_error("couldn't write " + path);
+}
+
+} // namespace assets::ktx2
@@ -0,0 +1,110 @@
+#include "assets/loader.h"
+
+#include "assets/ktx2.h"
+#include "parser/parser.h"
+
+#include <filesystem>
+#include <iostream>
+#include <optional>
+
+namespace assets {
+
+namespace {
+
+// `<name>.ktx2` beside `path`, unless it is missing or older than the source it was built from
+std::optional<std::filesystem::path> compressed_sibling(const std::filesystem::path &path) {
+	if (path.extension() == ".ktx2")
+		return path;
+
+	std::error_code ec;
+	auto			sibling		  = std::filesystem::path(path).replace_extension(".ktx2");
+	const auto		siblingMtime = std::filesystem::last_write_time(sibling, ec);
+	if (ec)
+		return std::nullopt;
+
+	if (const auto sourceMtime = std::filesystem::last_write_time(path, ec); !ec && sourceMtime > siblingMtime) {
+		std::cerr << "warning: " << sibling << " is older than " << path << ", ignoring it" << std::endl;
+		return std::nullopt;
+	}
+
+	return sibling;
+}
+
+} // namespace
+
+Loader::Loader(const size_t workers, TextureCache cache, const std::optional<MipFilter> mipFilter)
+	: _cache(std::move(cache)), _mipFilter(mipFilter), _pool(workers) {
+}
+
+std::future<geometry::Mesh> Loader::load_mesh(const std::string &path) {
+	return _pool.submit([this, path] {
+		const auto					  file = parser::parse(path);
+		std::vector<parser::Material> library;
+
+		for (const auto &lib : file.materialLibraries()) {
+			try {
+				auto materials = parser::parse_mtl(lib);
+				library.insert(library.end(), materials.begin(), materials.end());
+			} catch (const parser::ifs_error &e) {
+				// A missing library only costs the materials it defines, they fall back to the default one
+				std::cerr << "warning: " << path << ": " << e.what() << std::endl;
+			}
+		}
+
+		auto mesh = geometry::build_mesh(file, library);
+		for (const auto &material : mesh.materials) {
+			if (material.diffuse_map)
+				load_texture(*material.diffuse_map);
+		}
+
+		return mesh;
+	});
+}
+
+std::vector<std::future<geometry::Mesh>> Loader::load_meshes(const std::vector<std::string> &paths) {
+	std::vector<std::future<geometry::Mesh>> res;
+
+	res.reserve(paths.size());
+	for (const auto &path : paths)
+		res.push_back(load_mesh(path));
+
+	return res;
+}
+
+std::shared_future<graphics::resources::Texture> Loader::load_texture(const std::string &path, const bool allowCompressed) {
+	const auto		key = std::filesystem::weakly_canonical(path).string() + (allowCompressed ? "" : "#rgba");
+
+	std::lock_guard lock(_texturesMutex);
+	if (const auto it = _textures.find(key); it != _textures.end())
+		return it->second;
+
+	auto decode = [this, path, allowCompressed] {
+		if (const auto sibling = allowCompressed ? compressed_sibling(path) : std::nullopt) {
+			try {
+				return ktx2::read(sibling->string());
+			} catch (const std::runtime_error &e) {
+				std::cerr << "warning: " << e.what() << ", falling back to " << path << std::endl;
+			}
+		}
+
+		const std::string variant = !_mipFilter ? "no-mips" : *_mipFilter == MipFilter::Kaiser ? "kaiser" : "box";
+		if (auto cached = _cache.find(path, variant))
+			return std::move(*cached);
+
+		auto texture = graphics::resources::Texture::load(path);
+		if (!texture)
+			return texture;
+
+		if (_mipFilter)
+			texture = generate_mips(texture, *_mipFilter, &_pool);
+		_cache.store(path, variant, texture);
+		return texture;
+	};
+
+	auto future = _pool.submit(std::move(decode)).share();
+	_textures.emplace(key, future);
+
+	return future;
+}
+
+} // namespace assets
@@ -0,0 +1,194 @@
+#include "assets/mipmaps.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+
+namespace assets {
+
+namespace {
+
+using graphics::resources::Texture;
+
+// Compiles down to a single SSE/NEON register, one lane per channel
+typedef float Float4 __attribute__((vector_size(16)));
+
+constexpr size_t LINEAR_STEPS = 1 << 14;
+
+const std::array<float, 256> &srgb_to_linear() {
+	static const auto table = [] {
+		std::array<float, 256> res{};
+		for (size_t i = 0; i < res.size(); i++) {
+			const float c = static_cast<float>(i) / 255.0f;
+			res[i]		  = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+		}
+		return res;
+	}();
+	return table;
+}
+
+const std::array<uint8_t, LINEAR_STEPS> &linear_to_srgb() {
+	static const auto table = [] {
+		std::array<uint8_t, LINEAR_STEPS> res{};
+		for (size_t i = 0; i < res.size(); i++) {
+			const float l = static_cast<float>(i) / (LINEAR_STEPS - 1);
+			const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+			res[i]		  = static_cast<uint8_t>(std::lround(std::clamp(c, 0.0f, 1.0f) * 255.0f));
+		}
+		return res;
+	}();
+	return table;
+}
+
+Float4 load(const uint8_t *texel) {
+	const auto &lut = srgb_to_linear();
+	return Float4{lut[texel[0]], lut[texel[1]], lut[texel[2]], static_cast<float>(texel[3]) / 255.0f};
+}
+
+void store(uint8_t *texel, const Float4 value) {
+	const auto &lut = linear_to_srgb();
+	for (size_t c = 0; c < 3; c++)
+		texel[c] = lut[static_cast<size_t>(std::lround(std::clamp(value[c], 0.0f, 1.0f) * (LINEAR_STEPS - 1)))];
+	texel[3] = static_cast<uint8_t>(std::lround(std::clamp(value[3], 0.0f, 1.0f) * 255.0f));
+}
+
+struct Level {
+	uint8_t *pixels;
+	size_t	 w;
+	size_t	 h;
+
+	[[nodiscard]] uint8_t *texel(const size_t x, const size_t y) const {
+		return pixels + (y * w + x) * 4;
+	}
+};
+
+void box_row(const Level &src, const Level &dst, const size_t y) {
+	// Odd sizes clamp the second tap to the last row/column
+	const size_t y0 = std::min(2 * y, src.h - 1);
+	const size_t y1 = std::min(2 * y + 1, src.h - 1);
+
+	for (size_t x = 0; x < dst.w; x++) {
+		const size_t x0	 = std::min(2 * x, src.w - 1);
+		const size_t x1	 = std::min(2 * x + 1, src.w - 1);
+
+		const Float4 sum = load(src.texel(x0, y0)) + load(src.texel(x1, y0)) + load(src.texel(x0, y1)) + load(src.texel(x1, y1));
+		store(dst.texel(x, y), sum * 0.25f);
+	}
+}
+
+// Normalized filter taps of one destination coordinate, `first` being the (unclamped) first source coordinate
+struct Taps {
+	ptrdiff_t		   first;
+	std::vector<float> weights;
+};
+
+constexpr float KAISER_RADIUS = 2.0f; // in destination texels
+constexpr float KAISER_ALPHA  = 4.0f;
+
+// Modified Bessel function of the first kind, order 0 (std::cyl_bessel_i isn't available everywhere)
+float bessel_i0(const float x) {
+	float sum = 1.0f, term = 1.0f;
+	for (int k = 1; k < 32 && term > sum * 1e-7f; k++) {
+		term *= (x / (2.0f * static_cast<float>(k))) * (x / (2.0f * static_cast<float>(k)));
+		sum	 += term;
+	}
+	return sum;
+}
+
+float kaiser_weight(const float u) {
+	const auto sinc = [](const float x) { return x == 0.0f ? 1.0f : std::sin(std::numbers::pi_v<float> * x) / (std::numbers::pi_v<float> * x); };
+	const float r	= u / KAISER_RADIUS;
+	if (std::abs(r) >= 1.0f)
+		return 0.0f;
+	return sinc(u) * bessel_i0(KAISER_ALPHA * std::sqrt(1.0f - r * r)) / bessel_i0(KAISER_ALPHA);
+}
+
+std::vector<Taps> kaiser_taps(const size_t srcSize, const size_t dstSize) {
+	const float		  scale = static_cast<float>(srcSize) / static_cast<float>(dstSize);
+	std::vector<Taps> res(dstSize);
+
+	for (size_t i = 0; i < dstSize; i++) {
+		const float center = (static_cast<float>(i) + 0.5f) * scale;
+		const auto	first  = static_cast<ptrdiff_t>(std::floor(center - KAISER_RADIUS * scale));
+		const auto	last   = static_cast<ptrdiff_t>(std::ceil(center + KAISER_RADIUS * scale));
+
+		float		total  = 0.0f;
+		res[i].first	   = first;
+		for (ptrdiff_t s = first; s <= last; s++) {
+			const float weight = kaiser_weight((static_cast<float>(s) + 0.5f - center) / scale);
+			res[i].weights.push_back(weight);
+			total += weight;
+		}
+		for (auto &weight : res[i].weights)
+			weight /= total;
+	}
+
+	return res;
+}
+
+size_t clamp_coord(const ptrdiff_t coord, const size_t size) {
+	return static_cast<size_t>(std::clamp<ptrdiff_t>(coord, 0, static_cast<ptrdiff_t>(size) - 1));
+}
+
+// Separable: the source rows are first filtered vertically into `tmp`, which is then filtered horizontally
+void kaiser_row(const Level &src, const Level &dst, const size_t y, const std::vector<Taps> &tapsX, const Taps &tapsY, std::vector<Float4> &tmp) {
+	tmp.assign(src.w, Float4{});
+	for (size_t k = 0; k < tapsY.weights.size(); k++) {
+		const size_t sy		= clamp_coord(tapsY.first + static_cast<ptrdiff_t>(k), src.h);
+		const float	 weight = tapsY.weights[k];
+		for (size_t x = 0; x < src.w; x++)
+			tmp[x] += load(src.texel(x, sy)) * weight;
+	}
+
+	for (size_t x = 0; x < dst.w; x++) {
+		Float4 sum{};
+		for (size_t k = 0; k < tapsX[x].weights.size(); k++)
+			sum += tmp[clamp_coord(tapsX[x].first + static_cast<ptrdiff_t>(k), src.w)] * tapsX[x].weights[k];
+		store(dst.texel(x, y), sum);
+	}
+}
+
+} // namespace
+
+Texture generate_mips(const Texture &source, const MipFilter filter, ThreadPool *pool) {
+	if (!source || source.compressed() || source.channels != 4)
+		throw std::invalid_argument("mips can only be generated for RGBA8 textures");
+
+	Texture res = source;
+	res.levels	= Texture::mip_count(source.w, source.h);
+	res.pixels	= std::shared_ptr<uint8_t>(new uint8_t[res.device_size()], std::default_delete<uint8_t[]>());
+	std::copy_n(source.pixels.get(), source.level_size(0), res.pixels.get());
+
+	for (uint32_t level = 1; level < res.levels; level++) {
+		const Level src{res.pixels.get() + res.level_offset(level - 1), res.level_width(level - 1), res.level_height(level - 1)};
+		const Level dst{res.pixels.get() + res.level_offset(level), res.level_width(level), res.level_height(level)};
+
+		std::function<void(size_t)> row;
+		std::vector<Taps>			tapsX, tapsY;
+
+		if (filter == MipFilter::Kaiser) {
+			tapsX = kaiser_taps(src.w, dst.w);
+			tapsY = kaiser_taps(src.h, dst.h);
+			row	  = [&](const size_t y) {
+				  thread_local std::vector<Float4> tmp;
+				  kaiser_row(src, dst, y, tapsX, tapsY[y], tmp);
+			};
+		} else {
+			row = [&](const size_t y) { box_row(src, dst, y); };
+		}
+
+		// Each level depends on the previous one, so only the rows of a level run concurrently
+		if (pool && dst.h > 1)
+			pool->parallel_for(dst.h, row);
+		else
+			for (size_t y = 0; y < dst.h; y++)
+				row(y);
+	}
+
+	return res;
+}
+
+} // namespace assets
@@ -0,0 +1,45 @@
+#include "assets/png.h"
+
+#include <fstream>
+#include <limits>
+#include <png.h>
+#include <stdexcept>
+
+namespace assets::png {
+
+std::vector<uint8_t> encode(const uint32_t width, const uint32_t height, const std::span<const uint8_t> rgba) {
+	if (width == 0 || height == 0 || rgba.size() != size_t{width} * height * 4)
+		throw std::invalid_argument("pixel data doesn't match the image size");
+	// libpng takes the row stride as int
+	if (width > std::numeric_limits<int>::max() / 4)
+		throw std::invalid_argument("image too large for PNG encoding");
+
+	png_image image{};
+	image.version = PNG_IMAGE_VERSION;
+	image.width	  = width;
+	image.height  = height;
+	image.format  = PNG_FORMAT_RGBA;
+
+	// Sized by a first call without a buffer, which may overestimate
+	png_alloc_size_t size = 0;
+	if (!png_image_write_to_memory(&image, nullptr, &size, 0, rgba.data(), static_cast<png_int_32>(width * 4), nullptr))
+		throw std::runtime_error(std::string("couldn't encode PNG: ") + image.message);
+	std::vector<uint8_t> out(size);
+	if (!png_image_write_to_memory(&image, out.data(), &size, 0, rgba.data(), static_cast<png_int_32>(width * 4), nullptr))
+		throw std::runtime_error(std::string("couldn't encode PNG: ") + image.message);
+	out.resize(size);
+	return out;
+}
+
+void write(const std::string &path, const uint32_t width, const uint32_t height, const std::span<const uint8_t> rgba) {
+	const auto	  data = encode(width, height, rgba);
+
+	std::ofstream ofs(path, std::ios::binary);
+	if (!ofs)
+		throw std::runtime_error("couldn't open " + path + " for writing");
+	ofs.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+	if (!ofs)
+		throw std::runtime_error("couldn't write " + path);
+}
+
+} // namespace assets::png
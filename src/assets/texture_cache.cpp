@@ -0,0 +1,136 @@
+#include "assets/texture_cache.h"
+
+#include "assets/cache_files.h"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace assets {
+
+namespace {
+
+// Bump whenever the entry layout or the way mips are generated changes
+constexpr uint32_t			  CACHE_VERSION = 2;
+constexpr std::array<char, 8> CACHE_MAGIC{'S', 'C', 'O', 'P', 'T', 'E', 'X', '\0'};
+
+struct Header {
+	std::array<char, 8> magic;
+	uint32_t			version;
+	uint32_t			levels;
+	uint64_t			w;
+	uint64_t			h;
+	uint64_t			channels;
+	uint64_t			keySize;
+};
+
+// Identifies one revision of the source file and how it was processed, empty if it can't be stat'ed
+std::string source_key(const std::string &path, const std::string &variant) {
+	std::error_code ec;
+
+	const auto		canonical = std::filesystem::canonical(path, ec);
+	if (ec)
+		return {};
+	const auto size = std::filesystem::file_size(canonical, ec);
+	if (ec)
+		return {};
+	const auto mtime = std::filesystem::last_write_time(canonical, ec);
+	if (ec)
+		return {};
+
+	std::ostringstream oss;
+	oss << canonical.string() << '|' << size << '|' << mtime.time_since_epoch().count() << '|' << variant;
+	return oss.str();
+}
+
+std::filesystem::path entry_path(const std::filesystem::path &directory, const std::string &key) {
+	std::ostringstream oss;
+	oss << std::hex << std::hash<std::string>{}(key) << ".tex";
+	return directory / oss.str();
+}
+
+} // namespace
+
+TextureCache::TextureCache(std::filesystem::path directory) : _directory(std::move(directory)) {
+}
+
+std::optional<graphics::resources::Texture> TextureCache::find(const std::string &path, const std::string &variant) const {
+	if (!enabled())
+		return std::nullopt;
+
+	const auto key = source_key(path, variant);
+	if (key.empty())
+		return std::nullopt;
+
+	std::ifstream ifs(entry_path(_directory, key), std::ios::binary);
+	Header		  header{};
+	if (!ifs.read(reinterpret_cast<char *>(&header), sizeof(header)))
+		return std::nullopt;
+	if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.keySize != key.size())
+		return std::nullopt;
+
+	// Hash collisions and stale entries are told apart by the full key stored in the entry
+	std::string storedKey(header.keySize, '\0');
+	if (!ifs.read(storedKey.data(), static_cast<std::streamsize>(storedKey.size())) || storedKey != key)
+		return std::nullopt;
+
+	graphics::resources::Texture texture{
+		.pixels	  = nullptr,
+		.w		  = header.w,
+		.h		  = header.h,
+		.channels = header.channels,
+		.levels	  = header.levels,
+		.format	  = graphics::resources::Texture::Format::RGBA8_SRGB,
+	};
+	if (!header.w || !header.h || !header.channels || (header.levels != 1 && header.levels != graphics::resources::Texture::mip_count(header.w, header.h)))
+		return std::nullopt;
+
+	const auto size = texture.device_size();
+	if (size > cache_files::remaining(ifs))
+		return std::nullopt;
+	texture.pixels = std::shared_ptr<uint8_t>(new uint8_t[size], std::default_delete<uint8_t[]>());
+	if (!ifs.read(reinterpret_cast<char *>(texture.pixels.get()), static_cast<std::streamsize>(size)))
+		return std::nullopt;
+
+	return texture;
+}
+
+void TextureCache::store(const std::string &path, const std::string &variant, const graphics::resources::Texture &texture) const {
+	// Only decoded textures are worth caching, compressed ones are already read straight from their KTX2 file
+	if (!enabled() || !texture || texture.compressed())
+		return;
+
+	const auto key = source_key(path, variant);
+	if (key.empty())
+		return;
+
+	const Header header{
+		.magic	  = CACHE_MAGIC,
+		.version  = CACHE_VERSION,
+		.levels	  = texture.levels,
+		.w		  = texture.w,
+		.h		  = texture.h,
+		.channels = texture.channels,
+		.keySize  = key.size(),
+	};
+	cache_files::write(entry_path(_directory, key), "texture cache entry", [&](std::ostream &os) {
+		os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		os.write(key.data(), static_cast<std::streamsize>(key.size()));
+		os.write(reinterpret_cast<const char *>(texture.pixels.get()), static_cast<std::streamsize>(texture.device_size()));
+	});
+}
+
+bool TextureCache::enabled() const {
+	return !_directory.empty();
+}
+
+const std::filesystem::path &TextureCache::directory() const {
+	return _directory;
+}
+
+std::filesystem::path TextureCache::default_directory() {
+	return cache_files::default_directory("textures");
+}
+
+} // namespace assets
@@ -0,0 +1,129 @@
+#include "assets/texture_streaming.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace assets {
+
+TextureStreamer::TextureStreamer() : TextureStreamer(Config{}) {
+}
+
+TextureStreamer::TextureStreamer(const Config config) : _config(config) {
+}
+
+uint32_t TextureStreamer::add(const graphics::resources::Texture &texture) {
+	Entry entry{};
+	entry.extent = std::max(texture.w, texture.h);
+	for (uint32_t level = 0; level < texture.levels; level++)
+		entry.levelSizes.push_back(texture.level_size(level));
+
+	entry.tail = texture.levels - 1;
+	while (entry.tail > 0 && std::max(texture.level_width(entry.tail - 1), texture.level_height(entry.tail - 1)) <= _config.tailSize)
+		entry.tail--;
+	entry.base	   = entry.tail;
+	entry.resident = entry.tail;
+
+	_entries.push_back(std::move(entry));
+	return static_cast<uint32_t>(_entries.size() - 1);
+}
+
+void TextureStreamer::set_screen_size(const uint32_t texture, const float screenSize) {
+	_entries.at(texture).screenSize = screenSize;
+}
+
+size_t TextureStreamer::allocation_size(const Entry &entry, const uint32_t base) {
+	return std::accumulate(entry.levelSizes.begin() + base, entry.levelSizes.end(), size_t{0});
+}
+
+uint32_t TextureStreamer::wanted_level(const Entry &entry) {
+	if (entry.screenSize <= 0.0f)
+		return entry.tail;
+
+	// Largest level that still has at least one texel per covered pixel
+	const float ratio = static_cast<float>(entry.extent) / entry.screenSize;
+	if (ratio <= 1.0f)
+		return 0;
+	return std::min(entry.tail, static_cast<uint32_t>(std::floor(std::log2(ratio))));
+}
+
+TextureStreamer::Plan TextureStreamer::update() {
+	Plan				  plan;
+
+	// Most visible first
+	std::vector<uint32_t> order(_entries.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::ranges::stable_sort(order, std::greater{}, [this](const uint32_t i) { return _entries[i].screenSize; });
+
+	// Grow towards what each texture wants, never shrink unless the budget requires it
+	std::vector<uint32_t> targets(_entries.size());
+	size_t				  total = 0;
+	for (size_t i = 0; i < _entries.size(); i++) {
+		targets[i]	= std::min(_entries[i].base, wanted_level(_entries[i]));
+		total	   += allocation_size(_entries[i], targets[i]);
+	}
+
+	for (auto it = order.rbegin(); it != order.rend() && total > _config.memoryBudget; ++it) {
+		auto &entry = _entries[*it];
+		while (targets[*it] < entry.tail && total > _config.memoryBudget) {
+			total -= entry.levelSizes[targets[*it]];
+			targets[*it]++;
+		}
+	}
+
+	for (uint32_t i = 0; i < _entries.size(); i++) {
+		auto &entry = _entries[i];
+		if (targets[i] == entry.base)
+			continue;
+
+		const uint32_t keptFrom = std::max(entry.resident, targets[i]);
+		plan.reallocations.push_back({i, entry.base, targets[i], keptFrom});
+		entry.base	   = targets[i];
+		entry.resident = keptFrom;
+	}
+
+	size_t spent = 0;
+	for (const auto i : order) {
+		auto &entry = _entries[i];
+		while (entry.resident > entry.base) {
+			const size_t size = entry.levelSizes[entry.resident - 1];
+			if (spent > 0 && spent + size > _config.uploadBudget)
+				return plan;
+
+			plan.uploads.push_back({i, entry.resident - 1});
+			entry.resident--;
+			spent += size;
+		}
+	}
+
+	return plan;
+}
+
+uint32_t TextureStreamer::base(const uint32_t texture) const {
+	return _entries.at(texture).base;
+}
+
+uint32_t TextureStreamer::resident(const uint32_t texture) const {
+	return _entries.at(texture).resident;
+}
+
+uint32_t TextureStreamer::tail(const uint32_t texture) const {
+	return _entries.at(texture).tail;
+}
+
+size_t TextureStreamer::allocated_bytes() const {
+	size_t total = 0;
+	for (const auto &entry : _entries)
+		total += allocation_size(entry, entry.base);
+	return total;
+}
+
+size_t TextureStreamer::size() const {
+	return _entries.size();
+}
+
+const TextureStreamer::Config &TextureStreamer::config() const {
+	return _config;
+}
+
+} // namespace assets
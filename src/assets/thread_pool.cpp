@@ -0,0 +1,103 @@
+#include "assets/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace assets {
+
+ThreadPool::ThreadPool(size_t workers) {
+	if (workers == 0)
+		workers = 1;
+
+	_workers.reserve(workers);
+	for (size_t i = 0; i < workers; i++)
+		_workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard lock(_mutex);
+		_stopping = true;
+	}
+	_cv.notify_all();
+
+	for (auto &worker : _workers)
+		worker.join();
+}
+
+void ThreadPool::parallel_for(const size_t count, const std::function<void(size_t)> &body) {
+	struct State {
+		const std::function<void(size_t)> *body;
+		size_t								count;
+		std::atomic<size_t>					next{0};
+		std::atomic<size_t>					done{0};
+		std::exception_ptr					error;
+		std::mutex							mutex;
+		std::condition_variable				cv;
+	};
+
+	if (count == 0)
+		return;
+
+	// Helpers may only get to run after everything is done, they then find no index left and never touch `body`
+	auto state	 = std::make_shared<State>();
+	state->body	 = &body;
+	state->count = count;
+
+	auto run = [state] {
+		for (size_t i; (i = state->next.fetch_add(1)) < state->count;) {
+			try {
+				(*state->body)(i);
+			} catch (...) {
+				std::lock_guard lock(state->mutex);
+				if (!state->error)
+					state->error = std::current_exception();
+			}
+
+			if (state->done.fetch_add(1) + 1 == state->count) {
+				std::lock_guard lock(state->mutex);
+				state->cv.notify_all();
+			}
+		}
+	};
+
+	const size_t helpers = std::min(count, _workers.size() + 1) - 1;
+	{
+		std::lock_guard lock(_mutex);
+		for (size_t i = 0; i < helpers; i++)
+			_tasks.emplace(run);
+	}
+	_cv.notify_all();
+
+	run();
+
+	std::unique_lock lock(state->mutex);
+	state->cv.wait(lock, [&state] { return state->done == state->count; });
+	if (state->error)
+		std::rethrow_exception(state->error);
+}
+
+size_t ThreadPool::size() const {
+	return _workers.size();
+}
+
+void ThreadPool::work() {
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock lock(_mutex);
+			_cv.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+
+			// Pending tasks are drained before stopping, so no future is ever left broken
+			if (_tasks.empty())
+				return;
+
+			task = std::move(_tasks.front());
+			_tasks.pop();
+		}
+		task();
+	}
+}
+
+} // namespace assets
@@ -0,0 +1,317 @@
+#include "geometry/bvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace geometry {
+
+namespace {
+
+constexpr size_t   BIN_COUNT	= 16;
+// Leaves are split further only while the heuristic finds it worth it, and always above this
+constexpr uint32_t MAX_LEAF_SIZE = 8;
+
+} // namespace
+
+void Aabb::grow(const maths::Vec3 &p) {
+	const std::array coords{p.x(), p.y(), p.z()};
+	for (size_t axis = 0; axis < 3; axis++) {
+		min[axis] = std::min(min[axis], coords[axis]);
+		max[axis] = std::max(max[axis], coords[axis]);
+	}
+}
+
+void Aabb::grow(const Aabb &other) {
+	for (size_t axis = 0; axis < 3; axis++) {
+		min[axis] = std::min(min[axis], other.min[axis]);
+		max[axis] = std::max(max[axis], other.max[axis]);
+	}
+}
+
+bool Aabb::empty() const {
+	return min[0] > max[0] || min[1] > max[1] || min[2] > max[2];
+}
+
+float Aabb::surface_area() const {
+	if (empty())
+		return 0;
+
+	const float dx = max[0] - min[0];
+	const float dy = max[1] - min[1];
+	const float dz = max[2] - min[2];
+	return 2 * (dx * dy + dy * dz + dz * dx);
+}
+
+float Aabb::centroid(const size_t axis) const {
+	return (min[axis] + max[axis]) * 0.5f;
+}
+
+Aabb Aabb::transformed(const maths::Mat4 &m) const {
+	if (empty())
+		return {};
+
+	// Arvo's: each output coordinate is the translation plus, per input axis, the smaller or larger of both extremes
+	Aabb box;
+	for (size_t i = 0; i < 3; i++) {
+		box.min[i] = box.max[i] = m[3][i];
+		for (size_t j = 0; j < 3; j++) {
+			const float a = m[j][i] * min[j];
+			const float b = m[j][i] * max[j];
+			box.min[i] += std::min(a, b);
+			box.max[i] += std::max(a, b);
+		}
+	}
+	return box;
+}
+
+Frustum::Frustum(const maths::Mat4 &viewProj) {
+	// Lines are columns, so the rows of the matrix are read across them
+	const auto row = [&](const size_t r) { return std::array{viewProj[0][r], viewProj[1][r], viewProj[2][r], viewProj[3][r]}; };
+	const auto x   = row(0);
+	const auto y   = row(1);
+	const auto z   = row(2);
+	const auto w   = row(3);
+
+	for (size_t i = 0; i < 4; i++) {
+		_planes[0][i] = w[i] + x[i];
+		_planes[1][i] = w[i] - x[i];
+		_planes[2][i] = w[i] + y[i];
+		_planes[3][i] = w[i] - y[i];
+		_planes[4][i] = w[i] + z[i];
+		_planes[5][i] = w[i] - z[i];
+	}
+}
+
+const std::array<std::array<float, 4>, 6> &Frustum::planes() const {
+	return _planes;
+}
+
+Frustum::Test Frustum::test(const Aabb &box) const {
+	uint8_t planes = ALL_PLANES;
+	return test(box, planes);
+}
+
+Frustum::Test Frustum::test(const Aabb &box, uint8_t &planes) const {
+	if (box.empty())
+		return Test::OUTSIDE;
+
+	const std::array center{box.centroid(0), box.centroid(1), box.centroid(2)};
+	const std::array extent{box.max[0] - center[0], box.max[1] - center[1], box.max[2] - center[2]};
+
+	Test			 result = Test::INSIDE;
+	for (size_t i = 0; i < _planes.size(); i++) {
+		if (!(planes & 1u << i))
+			continue;
+
+		const auto &plane	 = _planes[i];
+		const float distance = plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3];
+		const float radius	 = std::abs(plane[0]) * extent[0] + std::abs(plane[1]) * extent[1] + std::abs(plane[2]) * extent[2];
+
+		if (distance < -radius)
+			return Test::OUTSIDE;
+		if (distance < radius)
+			result = Test::INTERSECTS;
+		else
+			planes &= ~(1u << i);
+	}
+	return result;
+}
+
+Bvh::Bvh(const std::span<const Aabb> boxes) : _boxes(boxes.begin(), boxes.end()) {
+	build();
+}
+
+void Bvh::fit(Node &node) const {
+	node.box = {};
+	for (uint32_t i = node.first; i < node.first + node.count; i++)
+		node.box.grow(_boxes[_items[i]]);
+}
+
+void Bvh::build() {
+	const auto count = static_cast<uint32_t>(_boxes.size());
+
+	_items.resize(count);
+	std::iota(_items.begin(), _items.end(), 0);
+	_leaves.resize(count);
+	_nodes.clear();
+	if (count == 0)
+		return;
+
+	// A binary tree with a leaf per item at most, so nodes never move while being split
+	_nodes.reserve(size_t{2} * count - 1);
+	_nodes.push_back({.box = {}, .first = 0, .count = count, .left = NONE, .parent = NONE});
+	fit(_nodes[0]);
+
+	std::vector<uint32_t> pending{0};
+	while (!pending.empty()) {
+		const uint32_t idx = pending.back();
+		pending.pop_back();
+		Node &node = _nodes[idx];
+
+		const auto begin = _items.begin() + node.first;
+		const auto end	 = begin + node.count;
+
+		Aabb	   centroids;
+		for (auto it = begin; it != end; ++it) {
+			const Aabb &box = _boxes[*it];
+			centroids.grow(maths::Vec3(box.centroid(0), box.centroid(1), box.centroid(2)));
+		}
+
+		// Binned surface area heuristic: items are bucketed by centroid along each axis, and the split between buckets
+		// minimising the summed area-weighted counts of both sides wins
+		float	 bestCost = node.box.surface_area() * static_cast<float>(node.count);
+		size_t	 bestAxis = 3;
+		size_t	 bestBin  = 0;
+		for (size_t axis = 0; axis < 3; axis++) {
+			const float extent = centroids.max[axis] - centroids.min[axis];
+			if (extent <= 0)
+				continue;
+
+			std::array<Aabb, BIN_COUNT>		bins;
+			std::array<uint32_t, BIN_COUNT> counts{};
+			const float						scale = BIN_COUNT / extent;
+			for (auto it = begin; it != end; ++it) {
+				const Aabb &box = _boxes[*it];
+				const auto	bin = std::min(BIN_COUNT - 1, static_cast<size_t>((box.centroid(axis) - centroids.min[axis]) * scale));
+				bins[bin].grow(box);
+				counts[bin]++;
+			}
+
+			// Right side costs of splitting before each bin, then swept against the growing left side
+			std::array<float, BIN_COUNT> rightCosts{};
+			Aabb						 right;
+			uint32_t					 rightCount = 0;
+			for (size_t bin = BIN_COUNT - 1; bin > 0; bin--) {
+				right.grow(bins[bin]);
+				rightCount += counts[bin];
+				rightCosts[bin] = right.surface_area() * static_cast<float>(rightCount);
+			}
+
+			Aabb	 left;
+			uint32_t leftCount = 0;
+			for (size_t bin = 1; bin < BIN_COUNT; bin++) {
+				left.grow(bins[bin - 1]);
+				leftCount += counts[bin - 1];
+				const float cost = left.surface_area() * static_cast<float>(leftCount) + rightCosts[bin];
+				if (leftCount > 0 && leftCount < node.count && cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin	 = bin;
+				}
+			}
+		}
+
+		auto middle = begin;
+		if (bestAxis < 3) {
+			const float scale = BIN_COUNT / (centroids.max[bestAxis] - centroids.min[bestAxis]);
+			middle			  = std::partition(begin, end, [&](const uint32_t item) {
+				   const auto bin = std::min(BIN_COUNT - 1, static_cast<size_t>((_boxes[item].centroid(bestAxis) - centroids.min[bestAxis]) * scale));
+				   return bin < bestBin;
+			   });
+		} else if (node.count > MAX_LEAF_SIZE) {
+			// Nothing worth it, or every centroid at the same place: halves along the longest axis keep leaves small
+			size_t axis = 0;
+			for (size_t i = 1; i < 3; i++) {
+				if (node.box.max[i] - node.box.min[i] > node.box.max[axis] - node.box.min[axis])
+					axis = i;
+			}
+			middle = begin + node.count / 2;
+			std::nth_element(begin, middle, end, [&](const uint32_t a, const uint32_t b) { return _boxes[a].centroid(axis) < _boxes[b].centroid(axis); });
+		} else {
+			for (auto it = begin; it != end; ++it)
+				_leaves[*it] = idx;
+			continue;
+		}
+
+		const auto leftCount = static_cast<uint32_t>(middle - begin);
+		node.left			 = static_cast<uint32_t>(_nodes.size());
+		_nodes.push_back({.box = {}, .first = node.first, .count = leftCount, .left = NONE, .parent = idx});
+		_nodes.push_back({.box = {}, .first = node.first + leftCount, .count = node.count - leftCount, .left = NONE, .parent = idx});
+		fit(_nodes[node.left]);
+		fit(_nodes[node.left + 1]);
+		pending.push_back(node.left);
+		pending.push_back(node.left + 1);
+	}
+}
+
+void Bvh::refit(const uint32_t item, const Aabb &box) {
+	_boxes[item]  = box;
+
+	uint32_t idx = _leaves[item];
+	fit(_nodes[idx]);
+	for (idx = _nodes[idx].parent; idx != NONE; idx = _nodes[idx].parent) {
+		Node &node = _nodes[idx];
+		Aabb  fitted = _nodes[node.left].box;
+		fitted.grow(_nodes[node.left + 1].box);
+		// Ancestors further up already cover what this one does
+		if (fitted == node.box)
+			break;
+		node.box = fitted;
+	}
+}
+
+std::vector<uint32_t> Bvh::split(const size_t parts) const {
+	if (_nodes.empty())
+		return {};
+
+	// Opens the largest node until there are enough, or only leaves
+	std::vector<uint32_t> nodes{0};
+	while (nodes.size() < parts) {
+		auto largest = nodes.end();
+		for (auto it = nodes.begin(); it != nodes.end(); ++it) {
+			if (!_nodes[*it].leaf() && (largest == nodes.end() || _nodes[*it].count > _nodes[*largest].count))
+				largest = it;
+		}
+		if (largest == nodes.end())
+			break;
+
+		const uint32_t left = _nodes[*largest].left;
+		*largest			= left;
+		nodes.push_back(left + 1);
+	}
+	return nodes;
+}
+
+void Bvh::cull(const Frustum &frustum, std::vector<uint32_t> &visible, const uint32_t node) const {
+	if (_nodes.empty())
+		return;
+
+	// Nodes along with the planes their parent straddles
+	std::vector<std::pair<uint32_t, uint8_t>> pending{{node, Frustum::ALL_PLANES}};
+	while (!pending.empty()) {
+		auto [idx, planes]	= pending.back();
+		const Node &current = _nodes[idx];
+		pending.pop_back();
+
+		switch (frustum.test(current.box, planes)) {
+			case Frustum::Test::OUTSIDE:
+				break;
+			case Frustum::Test::INSIDE:
+				visible.insert(visible.end(), _items.begin() + current.first, _items.begin() + current.first + current.count);
+				break;
+			case Frustum::Test::INTERSECTS:
+				if (!current.leaf()) {
+					pending.emplace_back(current.left, planes);
+					pending.emplace_back(current.left + 1, planes);
+					break;
+				}
+				for (uint32_t i = current.first; i < current.first + current.count; i++) {
+					uint8_t itemPlanes = planes;
+					if (frustum.test(_boxes[_items[i]], itemPlanes) != Frustum::Test::OUTSIDE)
+						visible.push_back(_items[i]);
+				}
+				break;
+		}
+	}
+}
+
+size_t Bvh::size() const {
+	return _boxes.size();
+}
+
+const Aabb &Bvh::bounds(const uint32_t item) const {
+	return _boxes[item];
+}
+
+} // namespace geometry
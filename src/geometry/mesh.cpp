@@ -0,0 +1,105 @@
+#include "geometry/mesh.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace geometry {
+
+namespace {
+
+std::vector<parser::Material> resolve_materials(const parser::File &file, const std::vector<parser::Material> &library) {
+	std::vector<parser::Material> materials;
+
+	materials.reserve(file.materialNames().size() + 1);
+	for (const auto &name : file.materialNames()) {
+		const auto it = std::ranges::find(library, name, &parser::Material::name);
+		materials.push_back(it != library.end() ? *it : parser::Material(name));
+	}
+
+	return materials;
+}
+
+} // namespace
+
+Mesh build_mesh(const parser::File &file, const std::vector<parser::Material> &library) {
+	Mesh										 mesh;
+	std::unordered_map<Vertex, Mesh::index_type> index_cache;
+
+	mesh.materials		  = resolve_materials(file, library);
+
+	// Faces without `usemtl` all share a trailing default material
+	const auto noMaterial = static_cast<uint32_t>(mesh.materials.size());
+	auto	   materialOf = [&](const parser::Face *face) { return face->material.value_or(noMaterial); };
+
+	std::vector<const parser::Face *> faces;
+	for (const auto &face : file)
+		faces.push_back(&face);
+
+	if (std::ranges::any_of(faces, [](const auto *face) { return !face->material; }))
+		mesh.materials.emplace_back();
+
+	// Stable, so the original face order is kept inside each material
+	std::ranges::stable_sort(faces, {}, materialOf);
+
+	for (const auto *face : faces) {
+		const auto	material = materialOf(face);
+		const auto &diffuse	 = mesh.materials[material].diffuse;
+
+		if (mesh.submeshes.empty() || mesh.submeshes.back().material != material)
+			mesh.submeshes.push_back({material, static_cast<uint32_t>(mesh.indices.size()), 0});
+
+		for (const auto &vertIndices : face->vertices) {
+			Vertex vertex;
+			vertex.color		= maths::Vec3{diffuse.r, diffuse.g, diffuse.b};
+
+			const auto position = file.vertex(vertIndices.vertex);
+			vertex.position.x() = position.x;
+			vertex.position.y() = position.y;
+			vertex.position.z() = position.z;
+
+			if (vertIndices.texture) {
+				const auto texture = file.texCoord(*vertIndices.texture);
+				vertex.tex.x()	   = texture.u;
+				vertex.tex.y()	   = 1.0f - texture.v;
+			}
+
+			mesh.submeshes.back().index_count++;
+
+			if (const auto it = index_cache.find(vertex); it != index_cache.end()) {
+				mesh.indices.push_back(it->second);
+				continue;
+			}
+
+			const auto index	= static_cast<Mesh::index_type>(mesh.vertices.size());
+			index_cache[vertex] = index;
+			mesh.indices.push_back(index);
+			mesh.vertices.push_back(vertex);
+		}
+	}
+
+	mesh.vertices.shrink_to_fit();
+	mesh.indices.shrink_to_fit();
+
+	return mesh;
+}
+
+void Mesh::append(const Mesh &other) {
+	const auto base			 = static_cast<index_type>(vertices.size());
+	const auto firstIndex	 = static_cast<uint32_t>(indices.size());
+	const auto firstMaterial = static_cast<uint32_t>(materials.size());
+
+	vertices.insert(vertices.end(), other.vertices.begin(), other.vertices.end());
+	materials.insert(materials.end(), other.materials.begin(), other.materials.end());
+
+	indices.reserve(indices.size() + other.indices.size());
+	for (const auto index : other.indices)
+		indices.push_back(base + index);
+
+	for (auto submesh : other.submeshes) {
+		submesh.material	+= firstMaterial;
+		submesh.first_index += firstIndex;
+		submeshes.push_back(submesh);
+	}
+}
+
+} // namespace geometry
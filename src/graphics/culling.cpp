@@ -0,0 +1,257 @@
+#include "graphics/vulkan.h"
+
+#include "application.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace graphics {
+
+namespace {
+
+// Below that many instances per thread, handing parts of the tree out costs more than culling them on this one
+constexpr size_t MIN_INSTANCES_PER_THREAD = 4096;
+
+} // namespace
+
+void VulkanInstance::cull(const uint32_t frame_idx, const SceneView &view) {
+	if (gpu_driven()) {
+		write_cull_view(frame_idx, view);
+		return;
+	}
+
+	// Boxes are in the scene's space, which the frame's model matrix moves as a whole
+	const geometry::Frustum frustum(view.model * view.view * view.proj);
+	const size_t			objects = _objects.size();
+
+	// A few parts per thread, as the tree's subtrees are seldom as visible as one another
+	const size_t			threads = std::clamp<size_t>(_bvh.size() / MIN_INSTANCES_PER_THREAD, 1, _recordThreads);
+	const auto				nodes	= threads > 1 ? _bvh.split(threads * 4) : std::vector<uint32_t>{0};
+
+	_visibleParts.resize(nodes.size());
+	_visibleCounts.assign(nodes.size() * objects, 0);
+	_recordPool->parallel_for(nodes.size(), [&](const size_t part) {
+		auto &visible = _visibleParts[part];
+		visible.clear();
+		_bvh.cull(frustum, visible, nodes[part]);
+		for (const uint32_t instance : visible)
+			_visibleCounts[part * objects + _instanceObjects[instance]]++;
+	});
+
+	// Objects' visible instances one after the other, and within an object each part's after the previous ones': counts
+	// become where each part writes next
+	std::vector<uint32_t> firstVisible(objects);
+	std::vector<uint32_t> visibleCount(objects);
+	uint32_t			  next = 0;
+	for (size_t object = 0; object < objects; object++) {
+		firstVisible[object] = next;
+		for (size_t part = 0; part < nodes.size(); part++)
+			next += std::exchange(_visibleCounts[part * objects + object], next);
+		visibleCount[object] = next - firstVisible[object];
+	}
+
+	// The frame's region is free since its fence was waited on
+	uint8_t *const region = _instanceBufferMapped + frame_idx * _instanceRegionSize;
+	_recordPool->parallel_for(nodes.size(), [&](const size_t part) {
+		for (const uint32_t instance : _visibleParts[part]) {
+			auto &slot = _visibleCounts[part * objects + _instanceObjects[instance]];
+			memcpy(region + slot++ * sizeof(maths::Mat4), &_instances[instance], sizeof(maths::Mat4));
+		}
+	});
+
+	std::vector<DrawBatch> batches;
+	batches.reserve(_batches.size());
+	for (auto batch : _batches) {
+		batch.firstInstance = firstVisible[batch.object];
+		batch.instanceCount = visibleCount[batch.object];
+		if (batch.instanceCount > 0)
+			batches.push_back(batch);
+	}
+
+	// Transforms are read from the buffer when the frame executes, only the draws themselves are recorded
+	if (batches != _frameBatches[frame_idx]) {
+		_frameBatches[frame_idx] = std::move(batches);
+		invalidate_command_buffers(frame_idx);
+	}
+}
+
+void VulkanInstance::write_cull_view(const uint32_t frame_idx, const SceneView &view) {
+	// Objects are tested placed, but without the scene's own movement: it is in their models
+	const geometry::Frustum frustum(view.view * view.proj);
+	uint8_t *const			region = _cullBuffers.viewMapped + frame_idx * _cullBuffers.viewRegionSize;
+
+	const CullUniforms		uniforms{.planes		= frustum.planes(),
+									 .viewProj		= view.view * view.proj,
+									 .instanceCount = static_cast<uint32_t>(_instances.size()),
+									 .drawCount		= static_cast<uint32_t>(_batches.size())};
+	memcpy(region, &uniforms, sizeof uniforms);
+	for (size_t object = 0; object < _objects.size(); object++) {
+		const auto model = _objects[object].transform * view.model;
+		memcpy(region + sizeof uniforms + object * sizeof model, &model, sizeof model);
+	}
+
+	// The frame's region of the instance buffer is free since its fence was waited on
+	uint8_t *const instances = _instanceBufferMapped + frame_idx * _instanceRegionSize;
+	for (const uint32_t instance : _pendingMoves[frame_idx])
+		memcpy(instances + instance * sizeof(maths::Mat4), &_instances[instance], sizeof(maths::Mat4));
+	_pendingMoves[frame_idx].clear();
+}
+
+void VulkanInstance::record_cull_pass(const VkCommandBuffer command_buffer, const uint32_t frame_idx, const bool late) const {
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+
+	// The pass following the pyramid goes on with the commands of the first, the barrier ending the pyramid covering both
+	if (!late) {
+		// Instance counts start from zero, the rest of the commands never changes
+		const VkDeviceSize commands = _batches.size() * (_occlusionCulling ? 2 : 1);
+		const VkBufferCopy copy{0, frame_idx * _cullBuffers.drawsRegionSize, sizeof(VkDrawIndexedIndirectCommand) * commands};
+		if (copy.size > 0)
+			vkCmdCopyBuffer(command_buffer, _cullBuffers.initialDraws.first, _cullBuffers.draws.first, 1, &copy);
+
+		// Along with the visibility the previous frame's second pass left
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+							 0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
+	constexpr uint32_t GROUP_SIZE = 64; // local_size_x of shaders/cull.glsl
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, _cullPipeline->pipeline);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, _cullPipeline->layout, 0, 1, &_cullDescriptorSets[frame_idx], 0, nullptr);
+	if (_occlusionCulling) {
+		const uint32_t pass = late ? 1 : 0;
+		vkCmdPushConstants(command_buffer, _cullPipeline->layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pass), &pass);
+	}
+	vkCmdDispatch(command_buffer, (static_cast<uint32_t>(_instances.size()) + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1,
+						 &barrier, 0, nullptr, 0, nullptr);
+}
+
+void VulkanInstance::create_depth_pyramid(const VkPhysicalDevice &physical) {
+	constexpr VkFormat format = VK_FORMAT_R32_SFLOAT;
+	_depthPyramid.extent	  = _swapchainExtent;
+	const uint32_t levels	  = resources::Texture::mip_count(_depthPyramid.extent.width, _depthPyramid.extent.height);
+	if (levels > MAX_PYRAMID_LEVELS) {
+		throw std::runtime_error("framebuffer too large for the depth pyramid");
+	}
+
+	std::tie(_depthPyramid.img, _depthPyramid.memory) =
+		create_image(physical, _depthPyramid.extent.width, _depthPyramid.extent.height, levels, VK_SAMPLE_COUNT_1_BIT, format, VK_IMAGE_TILING_OPTIMAL,
+					 VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	const auto view = create_image_view(_depthPyramid.img, format, VK_IMAGE_ASPECT_COLOR_BIT, levels);
+	if (!view) {
+		throw std::runtime_error("couldn't create image view for depth pyramid");
+	}
+	_depthPyramid.view = *view;
+	for (uint32_t level = 0; level < levels; level++) {
+		const auto levelView = create_image_view(_depthPyramid.img, format, VK_IMAGE_ASPECT_COLOR_BIT, 1, level);
+		if (!levelView) {
+			throw std::runtime_error("couldn't create image view for depth pyramid level " + std::to_string(level));
+		}
+		_depthPyramid.levelViews.push_back(*levelView);
+	}
+
+	// Culling binds it from the first frame on, before anything was ever written to it
+	transition_image_layout(_depthPyramid.img, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, levels);
+	std::cerr << "Created successfully depth pyramid of " << levels << " levels" << std::endl;
+}
+
+void VulkanInstance::write_pyramid_descriptors() {
+	const auto write = [](const VkDescriptorSet set, const uint32_t binding, const VkDescriptorType type, const VkDescriptorImageInfo &info) {
+		VkWriteDescriptorSet writeDescriptor{};
+		writeDescriptor.sType			= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writeDescriptor.dstSet			= set;
+		writeDescriptor.dstBinding		= binding;
+		writeDescriptor.dstArrayElement = 0;
+		writeDescriptor.descriptorType	= type;
+		writeDescriptor.descriptorCount = 1;
+		writeDescriptor.pImageInfo		= &info;
+		return writeDescriptor;
+	};
+
+	// Every level for culling. Each reduction reads the depth and the level before, which the first has none of: it is
+	// given its own, never read.
+	const VkDescriptorImageInfo			pyramidInfo{_pyramidSampler, _depthPyramid.view, VK_IMAGE_LAYOUT_GENERAL};
+	const VkDescriptorImageInfo			depthInfo{_pyramidSampler, _depthImgView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+	std::vector<VkDescriptorImageInfo>	levelInfos;
+	for (const auto &view : _depthPyramid.levelViews)
+		levelInfos.push_back({VK_NULL_HANDLE, view, VK_IMAGE_LAYOUT_GENERAL});
+
+	std::vector<VkWriteDescriptorSet> writeDescriptors;
+	for (const auto &set : _cullDescriptorSets)
+		writeDescriptors.push_back(write(set, 8, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, pyramidInfo));
+	for (size_t level = 0; level < levelInfos.size(); level++) {
+		const VkDescriptorSet set = _pyramidDescriptorSets[level];
+		writeDescriptors.push_back(write(set, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, depthInfo));
+		writeDescriptors.push_back(write(set, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, levelInfos[level > 0 ? level - 1 : 0]));
+		writeDescriptors.push_back(write(set, 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, levelInfos[level]));
+	}
+	vkUpdateDescriptorSets(_device, writeDescriptors.size(), writeDescriptors.data(), 0, nullptr);
+	std::cerr << "Updated depth pyramid descriptor sets" << std::endl;
+}
+
+void VulkanInstance::record_depth_pyramid(const VkCommandBuffer command_buffer) const {
+	// Last read by the previous frame's culling, and rewritten whole: what it holds doesn't matter
+	VkImageMemoryBarrier barrier{};
+	barrier.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout						= VK_IMAGE_LAYOUT_GENERAL;
+	barrier.newLayout						= VK_IMAGE_LAYOUT_GENERAL;
+	barrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	barrier.image							= _depthPyramid.img;
+	barrier.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel	= 0;
+	barrier.subresourceRange.levelCount		= VK_REMAINING_MIP_LEVELS;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount		= 1;
+	barrier.srcAccessMask					= 0;
+	barrier.dstAccessMask					= VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+						 &barrier);
+
+	// Each level is read by the next one's reduction, the last by culling
+	VkMemoryBarrier levelBarrier{};
+	levelBarrier.sType		   = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	levelBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	constexpr uint32_t GROUP_SIZE = 8; // local_size_x and local_size_y of shaders/depth_pyramid.glsl
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pyramidPipeline->pipeline);
+	for (uint32_t level = 0; level < _depthPyramid.levelViews.size(); level++) {
+		const uint32_t fromDepth = level == 0 ? 1 : 0;
+		const uint32_t width	 = std::max(1u, _depthPyramid.extent.width >> level);
+		const uint32_t height	 = std::max(1u, _depthPyramid.extent.height >> level);
+
+		vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pyramidPipeline->layout, 0, 1, &_pyramidDescriptorSets[level], 0,
+								nullptr);
+		vkCmdPushConstants(command_buffer, _pyramidPipeline->layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(fromDepth), &fromDepth);
+		vkCmdDispatch(command_buffer, (width + GROUP_SIZE - 1) / GROUP_SIZE, (height + GROUP_SIZE - 1) / GROUP_SIZE, 1);
+		vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &levelBarrier, 0, nullptr,
+							 0, nullptr);
+	}
+}
+
+void VulkanInstance::move_instance(const uint32_t object, const uint32_t instance, const maths::Mat4 &transform) {
+	const uint32_t idx					 = _firstInstances[object] + instance;
+	_objects[object].instances[instance] = transform;
+	_instances[idx]						 = transform;
+	_bvh.refit(idx, _objectBounds[object].transformed(transform * _objects[object].transform));
+
+	// GPU-driven, each frame's copy of the instances is patched when that frame comes around rather than written whole
+	if (gpu_driven()) {
+		for (auto &pending : _pendingMoves)
+			pending.push_back(idx);
+	}
+}
+
+} // namespace graphics
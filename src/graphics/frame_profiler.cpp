@@ -0,0 +1,139 @@
+#include "graphics/frame_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace graphics {
+
+namespace {
+
+// Nearest rank on sorted samples
+double percentile(const std::vector<double> &sorted, const double p) {
+	const auto rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+	return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+} // namespace
+
+FrameProfiler::Timer::Timer(FrameProfiler &profiler, const Scope scope)
+	: _profiler(profiler), _scope(scope), _frame(profiler.frame()), _start(std::chrono::steady_clock::now()) {
+}
+
+FrameProfiler::Timer::~Timer() {
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - _start;
+	_profiler.add(_frame, _scope, elapsed.count());
+}
+
+FrameProfiler::FrameProfiler(const size_t window) : _window(std::max<size_t>(window, 1)) {
+}
+
+uint64_t FrameProfiler::begin_frame() {
+	const auto now = std::chrono::steady_clock::now();
+	if (!_rows.empty())
+		add(_rows.back().frame, Scope::FRAME, std::chrono::duration<double, std::milli>(now - _frameStart).count());
+	_frameStart = now;
+
+	_rows.push_back({_next, {}});
+	if (_rows.size() > _window)
+		_rows.pop_front();
+	return _next++;
+}
+
+uint64_t FrameProfiler::frame() const {
+	return _next == 0 ? 0 : _next - 1;
+}
+
+void FrameProfiler::add(const uint64_t frame, const Scope scope, const double milliseconds) {
+	// Rows are numbered contiguously
+	if (_rows.empty() || frame < _rows.front().frame || frame > _rows.back().frame)
+		return;
+
+	auto &sample = _rows[frame - _rows.front().frame].milliseconds[static_cast<size_t>(scope)];
+	// Scopes entered several times in a frame add up
+	sample		 = sample.value_or(0.0) + milliseconds;
+}
+
+std::optional<FrameProfiler::Percentiles> FrameProfiler::percentiles(const Scope scope) const {
+	std::vector<double> samples;
+	samples.reserve(_rows.size());
+	for (const auto &row : _rows) {
+		if (const auto &sample = row.milliseconds[static_cast<size_t>(scope)])
+			samples.push_back(*sample);
+	}
+	if (samples.empty())
+		return std::nullopt;
+
+	std::ranges::sort(samples);
+	return Percentiles{percentile(samples, 50), percentile(samples, 95), percentile(samples, 99)};
+}
+
+void FrameProfiler::write_csv(std::ostream &os) const {
+	os << "frame";
+	for (size_t scope = 0; scope < SCOPE_COUNT; scope++)
+		os << ',' << name(static_cast<Scope>(scope));
+	os << '\n';
+
+	for (const auto &[frame, milliseconds] : _rows) {
+		os << frame;
+		for (const auto &sample : milliseconds) {
+			os << ',';
+			if (sample)
+				os << *sample;
+		}
+		os << '\n';
+	}
+}
+
+void FrameProfiler::write_json(std::ostream &os) const {
+	os << "{\n  \"percentiles\": {";
+	bool first = true;
+	for (size_t scope = 0; scope < SCOPE_COUNT; scope++) {
+		const auto stats = percentiles(static_cast<Scope>(scope));
+		if (!stats)
+			continue;
+		os << (first ? "\n" : ",\n") << "    \"" << name(static_cast<Scope>(scope)) << "\": {\"p50\": " << stats->p50 << ", \"p95\": " << stats->p95
+		   << ", \"p99\": " << stats->p99 << '}';
+		first = false;
+	}
+	os << "\n  },\n  \"frames\": [";
+
+	for (size_t i = 0; i < _rows.size(); i++) {
+		os << (i ? ",\n" : "\n") << "    {\"frame\": " << _rows[i].frame;
+		for (size_t scope = 0; scope < SCOPE_COUNT; scope++) {
+			os << ", \"" << name(static_cast<Scope>(scope)) << "\": ";
+			if (const auto &sample = _rows[i].milliseconds[scope])
+				os << *sample;
+			else
+				os << "null";
+		}
+		os << '}';
+	}
+	os << "\n  ]\n}\n";
+}
+
+std::string_view FrameProfiler::name(const Scope scope) {
+	switch (scope) {
+	case Scope::FRAME:
+		return "frame_ms";
+	case Scope::FENCE_WAIT:
+		return "fence_wait_ms";
+	case Scope::ACQUIRE:
+		return "acquire_ms";
+	case Scope::RECORD:
+		return "record_ms";
+	case Scope::CULL:
+		return "cull_ms";
+	case Scope::SUBMIT:
+		return "submit_ms";
+	case Scope::PRESENT:
+		return "present_ms";
+	case Scope::GPU_UPLOAD:
+		return "gpu_upload_ms";
+	case Scope::GPU_RENDER_PASS:
+		return "gpu_render_pass_ms";
+	}
+	return "unknown";
+}
+
+} // namespace graphics
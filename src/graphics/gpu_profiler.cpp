@@ -0,0 +1,89 @@
+#include "graphics/gpu_profiler.h"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace graphics {
+
+GpuProfiler::GpuProfiler(const VkDevice device, const VkPhysicalDevice &physical, const uint32_t queueFamily, const uint32_t framesInFlight)
+	: _device(device), _pending(framesInFlight) {
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(physical, &props);
+
+	uint32_t familyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physical, &familyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> families(familyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physical, &familyCount, families.data());
+
+	const uint32_t validBits = queueFamily < families.size() ? families[queueFamily].timestampValidBits : 0;
+	if (validBits == 0 || props.limits.timestampPeriod <= 0.0f) {
+		std::cerr << "warning: the graphics queue has no timestamps, GPU passes won't be profiled" << std::endl;
+		return;
+	}
+	_period = props.limits.timestampPeriod;
+	_mask	= validBits >= 64 ? ~uint64_t{0} : (uint64_t{1} << validBits) - 1;
+
+	VkQueryPoolCreateInfo createInfo{};
+	createInfo.sType	  = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	createInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+	createInfo.queryCount = framesInFlight * QUERIES_PER_FRAME;
+
+	if (vkCreateQueryPool(_device, &createInfo, nullptr, &_pool) != VK_SUCCESS) {
+		throw std::runtime_error("couldn't create timestamp query pool");
+	}
+	std::cerr << "Created successfully timestamp query pool" << std::endl;
+}
+
+GpuProfiler::~GpuProfiler() {
+	vkDestroyQueryPool(_device, _pool, nullptr);
+}
+
+uint32_t GpuProfiler::query(const uint32_t frame_idx, const Pass pass) const {
+	return frame_idx * QUERIES_PER_FRAME + static_cast<uint32_t>(pass) * 2;
+}
+
+void GpuProfiler::reset(const VkCommandBuffer cmdBuffer, const uint32_t frame_idx, const uint64_t frame) {
+	if (!_pool)
+		return;
+
+	vkCmdResetQueryPool(cmdBuffer, _pool, frame_idx * QUERIES_PER_FRAME, QUERIES_PER_FRAME);
+	_pending[frame_idx] = frame;
+}
+
+void GpuProfiler::begin(const VkCommandBuffer cmdBuffer, const uint32_t frame_idx, const Pass pass) const {
+	if (_pool)
+		vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _pool, query(frame_idx, pass));
+}
+
+void GpuProfiler::end(const VkCommandBuffer cmdBuffer, const uint32_t frame_idx, const Pass pass) const {
+	if (_pool)
+		vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _pool, query(frame_idx, pass) + 1);
+}
+
+void GpuProfiler::collect(const uint32_t frame_idx, FrameProfiler &profiler) {
+	if (!_pool || !_pending[frame_idx])
+		return;
+
+	// Value then availability for each query; no wait flag, a pass that somehow isn't done yet is skipped
+	std::array<uint64_t, QUERIES_PER_FRAME * 2> results{};
+	const VkResult res = vkGetQueryPoolResults(_device, _pool, frame_idx * QUERIES_PER_FRAME, QUERIES_PER_FRAME, sizeof(results), results.data(),
+											   2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+	if (res != VK_SUCCESS && res != VK_NOT_READY)
+		throw std::runtime_error("couldn't read timestamp queries back");
+
+	const uint64_t frame = *_pending[frame_idx];
+	_pending[frame_idx]	 = std::nullopt;
+
+	constexpr std::array scopes{FrameProfiler::Scope::GPU_UPLOAD, FrameProfiler::Scope::GPU_RENDER_PASS};
+	for (uint32_t pass = 0; pass < PASS_COUNT; pass++) {
+		const uint64_t *begin = &results[pass * 4];
+		const uint64_t *end	  = &results[pass * 4 + 2];
+		if (!begin[1] || !end[1])
+			continue;
+
+		const uint64_t ticks = ((end[0] & _mask) - (begin[0] & _mask)) & _mask;
+		profiler.add(frame, scopes[pass], static_cast<double>(ticks) * _period / 1e6);
+	}
+}
+
+} // namespace graphics
@@ -2,26 +2,97 @@
 
 #include "graphics/utils.h"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <sstream>
 
 namespace graphics {
 
-Pipeline::Pipeline(VkDevice &device, std::string vertex_path, std::string fragment_path, const VkSampleCountFlagBits msaaSamples)
-	: device(device), msaaSamples(msaaSamples) {
-	shaders.emplace("vertex", ShaderData(std::make_shared<resources::Shader>(std::move(vertex_path))));
-	shaders.emplace("fragment", ShaderData(std::make_shared<resources::Shader>(std::move(fragment_path))));
+namespace {
+
+using resources::ShaderReflection;
+
+// constant_id sizing the fragment shader's sampler array, see create_graphics_pipeline
+constexpr uint32_t TEXTURE_SLOTS_CONSTANT_ID = 0;
+
+VkDescriptorType descriptor_type(const ShaderReflection::DescriptorType type) {
+	switch (type) {
+	case ShaderReflection::DescriptorType::UNIFORM_BUFFER:
+		return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	case ShaderReflection::DescriptorType::STORAGE_BUFFER:
+		return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	case ShaderReflection::DescriptorType::COMBINED_IMAGE_SAMPLER:
+		return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	case ShaderReflection::DescriptorType::SAMPLED_IMAGE:
+		return VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+	case ShaderReflection::DescriptorType::STORAGE_IMAGE:
+		return VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	case ShaderReflection::DescriptorType::SAMPLER:
+		return VK_DESCRIPTOR_TYPE_SAMPLER;
+	case ShaderReflection::DescriptorType::UNIFORM_TEXEL_BUFFER:
+		return VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+	case ShaderReflection::DescriptorType::STORAGE_TEXEL_BUFFER:
+		return VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+	case ShaderReflection::DescriptorType::INPUT_ATTACHMENT:
+		return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+	}
+	throw std::runtime_error("unknown descriptor type");
+}
+
+// Format a vertex attribute needs to feed `input`, VK_FORMAT_UNDEFINED for the ones vertex buffers can't
+VkFormat input_format(const ShaderReflection::Input &input) {
+	if (input.width != 32 || input.columns != 1 || input.components < 1 || input.components > 4)
+		return VK_FORMAT_UNDEFINED;
+
+	static constexpr std::array floats{VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT};
+	static constexpr std::array sints{VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT};
+	static constexpr std::array uints{VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT};
+
+	switch (input.type) {
+	case ShaderReflection::ScalarType::FLOAT:
+		return floats[input.components - 1];
+	case ShaderReflection::ScalarType::SINT:
+		return sints[input.components - 1];
+	case ShaderReflection::ScalarType::UINT:
+		return uints[input.components - 1];
+	}
+	return VK_FORMAT_UNDEFINED;
+}
+
+std::vector<VkDescriptorPoolSize> pool_sizes(const std::vector<VkDescriptorSetLayoutBinding> &bindings, const uint32_t setCount) {
+	std::map<VkDescriptorType, uint32_t> counts;
+	for (const auto &binding : bindings)
+		counts[binding.descriptorType] += binding.descriptorCount * setCount;
+
+	std::vector<VkDescriptorPoolSize> ret;
+	for (const auto &[type, count] : counts)
+		ret.push_back({type, count});
+	return ret;
+}
+
+} // namespace
+
+Pipeline::Pipeline(VkDevice &device, std::shared_ptr<resources::Shader> vertex, std::shared_ptr<resources::Shader> fragment,
+				   const VkSampleCountFlagBits msaaSamples, const uint32_t textureSlots)
+	: device(device), msaaSamples(msaaSamples), textureSlots(textureSlots) {
+	shaders.emplace("vertex", ShaderData(std::move(vertex)));
+	shaders.emplace("fragment", ShaderData(std::move(fragment)));
 }
 
 Pipeline::~Pipeline() {
 	vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
 
-	vkDestroyPipeline(device, pipeline, nullptr);
+	for (const auto &[variant, pipeline] : pipelines)
+		vkDestroyPipeline(device, pipeline, nullptr);
 
 	vkDestroyPipelineLayout(device, layout, nullptr);
 
 	vkDestroyRenderPass(device, renderPass, nullptr);
+	vkDestroyRenderPass(device, earlyRenderPass, nullptr);
 
 	for (auto &[stage_name, data] : shaders) {
 		if (!data.module) {
@@ -31,14 +102,8 @@ Pipeline::~Pipeline() {
 	}
 }
 
-auto Pipeline::compile_shaders() const -> bool {
-	bool res = true;
-
-	for (const auto &[stage_name, data] : shaders) {
-		res &= data.resource->compile();
-	}
-
-	return res;
+auto Pipeline::shaders_compiled() const -> bool {
+	return std::ranges::all_of(shaders, [](const auto &stage) { return stage.second.resource->is_compiled(); });
 }
 
 auto Pipeline::get_num_errors() const -> std::pair<size_t, size_t> {
@@ -85,28 +150,43 @@ void Pipeline::setup_shader_modules() {
 		if (data.module) {
 			continue;
 		}
+		setup_shader_module(device, stage_name, data);
+	}
+}
 
-		data.module = create_module(device, data.resource->compiled(), stage_name);
+void Pipeline::setup_shader_module(const VkDevice &device, const std::string &stage_name, ShaderData &data) {
+	const auto						 code = data.resource->compiled();
+
+	decltype(data.stage)::value_type stage{};
+	stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+
+	ShaderReflection::Stage expected;
+	if (stage_name == "vertex") {
+		stage.stage = VK_SHADER_STAGE_VERTEX_BIT;
+		expected	= ShaderReflection::Stage::VERTEX;
+	} else if (stage_name == "fragment") {
+		stage.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		expected	= ShaderReflection::Stage::FRAGMENT;
+	} else if (stage_name == "compute") {
+		stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		expected	= ShaderReflection::Stage::COMPUTE;
+	} else {
+		throw std::runtime_error("stage " + stage_name + " not handled yet");
+	}
 
-		decltype(data.stage)::value_type stage{};
-		stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	data.reflection = resources::reflect(code);
+	if (data.reflection->stage != expected)
+		throw std::runtime_error(data.resource->path() + " isn't a " + stage_name + " shader");
 
-		if (stage_name == "vertex") {
-			stage.stage = VK_SHADER_STAGE_VERTEX_BIT;
-		} else if (stage_name == "fragment") {
-			stage.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		} else {
-			throw std::runtime_error("stage " + stage_name + " not handled yet");
-		}
+	data.module = create_module(device, code, stage_name);
 
-		stage.module = *data.module;
-		stage.pName	 = "main";
+	stage.module = *data.module;
+	stage.pName	 = "main";
 
-		data.stage	 = stage;
-	}
+	data.stage	 = stage;
 }
 
-void Pipeline::setup_render_pass(const VkFormat &format, const VkFormat &depthFormat) {
+void Pipeline::setup_render_pass(const VkFormat &format, const VkFormat &depthFormat, const VkImageLayout finalLayout, const bool occlusion) {
 	VkAttachmentDescription colorAttachment{};
 	colorAttachment.format		   = format;
 	colorAttachment.samples		   = msaaSamples;
@@ -135,7 +215,7 @@ void Pipeline::setup_render_pass(const VkFormat &format, const VkFormat &depthFo
 	colorResolveAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorResolveAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorResolveAttachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorResolveAttachment.finalLayout	  = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	colorResolveAttachment.finalLayout	  = finalLayout;
 
 	VkAttachmentReference colorAttachmentRef{};
 	colorAttachmentRef.attachment = 0; // idx of layout in fragment shader
@@ -163,7 +243,7 @@ void Pipeline::setup_render_pass(const VkFormat &format, const VkFormat &depthFo
 	subpassDependency.dstStageMask	= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
 	subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
-	const std::array	   attachments{colorAttachment, depthAttachment, colorResolveAttachment};
+	std::array			   attachments{colorAttachment, depthAttachment, colorResolveAttachment};
 
 	VkRenderPassCreateInfo renderPassCreateInfo{};
 	renderPassCreateInfo.sType			 = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -174,6 +254,46 @@ void Pipeline::setup_render_pass(const VkFormat &format, const VkFormat &depthFo
 	renderPassCreateInfo.dependencyCount = 1;
 	renderPassCreateInfo.pDependencies	 = &subpassDependency;
 
+	if (occlusion) {
+		// The first pass keeps its depth for the pyramid, read by compute, and its samples for the second to go on with:
+		// what it resolves is overwritten by the second's resolve
+		VkSubpassDependency toPyramid{};
+		toPyramid.srcSubpass	= 0;
+		toPyramid.dstSubpass	= VK_SUBPASS_EXTERNAL;
+		toPyramid.srcStageMask	= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+		toPyramid.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		toPyramid.dstStageMask	= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		toPyramid.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		const std::array earlyDependencies{subpassDependency, toPyramid};
+		auto			 early = attachments;
+		early[1].storeOp	 = VK_ATTACHMENT_STORE_OP_STORE;
+		early[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		early[2].storeOp	 = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		early[2].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		renderPassCreateInfo.pAttachments	 = early.data();
+		renderPassCreateInfo.dependencyCount = earlyDependencies.size();
+		renderPassCreateInfo.pDependencies	 = earlyDependencies.data();
+		if (vkCreateRenderPass(device, &renderPassCreateInfo, nullptr, &earlyRenderPass) != VK_SUCCESS) {
+			throw std::runtime_error("couldn't create early render pass for current device");
+		}
+
+		// The second loads all of it, once the pyramid was built from the depth and the draws it feeds were culled
+		attachments[0].loadOp		 = VK_ATTACHMENT_LOAD_OP_LOAD;
+		attachments[0].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		attachments[1].loadOp		 = VK_ATTACHMENT_LOAD_OP_LOAD;
+		attachments[1].initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+		subpassDependency.srcStageMask	|= VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		subpassDependency.srcAccessMask	 = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		subpassDependency.dstAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+
+		renderPassCreateInfo.pAttachments	 = attachments.data();
+		renderPassCreateInfo.dependencyCount = 1;
+		renderPassCreateInfo.pDependencies	 = &subpassDependency;
+	}
+
 	if (vkCreateRenderPass(device, &renderPassCreateInfo, nullptr, &renderPass) != VK_SUCCESS) {
 		throw std::runtime_error("couldn't create render pass for current device");
 	}
@@ -181,21 +301,31 @@ void Pipeline::setup_render_pass(const VkFormat &format, const VkFormat &depthFo
 }
 
 void Pipeline::create_descriptor_set_layout() {
-	VkDescriptorSetLayoutBinding uboLayoutBinding{};
-	uboLayoutBinding.binding			= 0;
-	uboLayoutBinding.descriptorType		= VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	uboLayoutBinding.descriptorCount	= 1;
-	uboLayoutBinding.stageFlags			= VK_SHADER_STAGE_VERTEX_BIT;
-	uboLayoutBinding.pImmutableSamplers = nullptr;
-
-	VkDescriptorSetLayoutBinding samplerBinding{};
-	samplerBinding.binding			  = 1;
-	samplerBinding.descriptorType	  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	samplerBinding.descriptorCount	  = 1;
-	samplerBinding.stageFlags		  = VK_SHADER_STAGE_FRAGMENT_BIT;
-	samplerBinding.pImmutableSamplers = nullptr;
-
-	const std::array				bindings{uboLayoutBinding, samplerBinding};
+	// Bindings used by several stages are merged, they have to agree on what is bound there
+	std::map<uint32_t, VkDescriptorSetLayoutBinding> merged;
+	for (const auto &[stage_name, data] : shaders) {
+		for (const auto &binding : data.reflection->bindings) {
+			if (binding.set != 0)
+				throw std::runtime_error(stage_name + " shader uses descriptor set " + std::to_string(binding.set) + ", only set 0 is bound");
+			if (binding.count == 0)
+				throw std::runtime_error(stage_name + " shader uses a runtime sized array at binding " + std::to_string(binding.binding));
+
+			// Arrays sized by a specialization constant get the value it is specialized with
+			const uint32_t count = binding.countSpecId == TEXTURE_SLOTS_CONSTANT_ID ? textureSlots : binding.count;
+			auto		   type	 = descriptor_type(binding.type);
+			if (binding.binding == OBJECT_UNIFORMS_BINDING && type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+				type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+
+			auto [it, inserted]	 = merged.try_emplace(binding.binding, VkDescriptorSetLayoutBinding{binding.binding, type, count, 0, nullptr});
+			if (!inserted && (it->second.descriptorType != type || it->second.descriptorCount != count))
+				throw std::runtime_error("shaders disagree on the descriptor at binding " + std::to_string(binding.binding));
+			it->second.stageFlags |= data.stage->stage;
+		}
+	}
+
+	bindings.clear();
+	for (const auto &[index, binding] : merged)
+		bindings.push_back(binding);
 
 	VkDescriptorSetLayoutCreateInfo createInfo{};
 	createInfo.sType		= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -209,8 +339,55 @@ void Pipeline::create_descriptor_set_layout() {
 	std::cerr << "Created descriptor set layout successfully" << std::endl;
 }
 
+auto Pipeline::descriptor_pool_sizes(const uint32_t setCount) const -> std::vector<VkDescriptorPoolSize> {
+	return pool_sizes(bindings, setCount);
+}
+
+void Pipeline::setup(const VkPipelineCache pipelineCache) {
+	cache = pipelineCache;
+
+	// Every stage declares the whole block, so a single range covers them all
+	VkPushConstantRange pushConstantRange{};
+	pushConstantStages = 0;
+	for (const auto &[stage_name, data] : shaders) {
+		if (data.reflection->pushConstantSize == 0)
+			continue;
+		pushConstantStages		|= data.stage->stage;
+		pushConstantRange.size	 = std::max(pushConstantRange.size, data.reflection->pushConstantSize);
+	}
+	pushConstantRange.stageFlags = pushConstantStages;
+	pushConstantRange.offset	 = 0;
+
+	VkPipelineLayoutCreateInfo pipelineCreateInfo{};
+	pipelineCreateInfo.sType				  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineCreateInfo.setLayoutCount		  = 1;
+	pipelineCreateInfo.pSetLayouts			  = &descriptorSetLayout;
+	pipelineCreateInfo.pushConstantRangeCount = pushConstantStages ? 1 : 0;
+	pipelineCreateInfo.pPushConstantRanges	  = &pushConstantRange;
+
+	if (vkCreatePipelineLayout(device, &pipelineCreateInfo, nullptr, &layout) != VK_SUCCESS) {
+		throw std::runtime_error("couldn't create pipeline layout for current device");
+	}
+
+	std::cerr << "Created successfully pipeline layout for current device" << std::endl;
+}
+
+VkPipeline Pipeline::get(const PipelineVariant &variant) {
+	if (const auto it = pipelines.find(variant); it != pipelines.end())
+		return it->second;
+
+	return pipelines[variant] = create_graphics_pipeline(current_stages(), variant, cache);
+}
 
-void Pipeline::setup(const VkExtent2D &extent) {
+auto Pipeline::variants() const -> std::vector<PipelineVariant> {
+	std::vector<PipelineVariant> ret;
+	for (const auto &[variant, pipeline] : pipelines)
+		ret.push_back(variant);
+	return ret;
+}
+
+VkPipeline Pipeline::create_graphics_pipeline(const std::vector<VkPipelineShaderStageCreateInfo> &shaderStages, const PipelineVariant &variant,
+											  const VkPipelineCache cache) const {
 	static std::vector				 dynamicStates{VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
 
 	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{};
@@ -218,13 +395,13 @@ void Pipeline::setup(const VkExtent2D &extent) {
 	dynamicStateCreateInfo.dynamicStateCount		 = static_cast<uint32_t>(dynamicStates.size());
 	dynamicStateCreateInfo.pDynamicStates			 = dynamicStates.data();
 
-	const auto							&bindingDesc = VertexData::getBindingDesc();
-	const auto							&attrsDescs	 = VertexData::getAttributeDescs();
+	const auto							&bindingDescs = VertexData::getBindingDescs();
+	const auto							&attrsDescs	  = vertex_attributes();
 
 	VkPipelineVertexInputStateCreateInfo vertexInputCreateInfo{};
 	vertexInputCreateInfo.sType							  = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputCreateInfo.vertexBindingDescriptionCount	  = 1;
-	vertexInputCreateInfo.pVertexBindingDescriptions	  = &bindingDesc;
+	vertexInputCreateInfo.vertexBindingDescriptionCount	  = bindingDescs.size();
+	vertexInputCreateInfo.pVertexBindingDescriptions	  = bindingDescs.data();
 	vertexInputCreateInfo.vertexAttributeDescriptionCount = attrsDescs.size();
 	vertexInputCreateInfo.pVertexAttributeDescriptions	  = attrsDescs.data();
 
@@ -233,18 +410,6 @@ void Pipeline::setup(const VkExtent2D &extent) {
 	inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
 	inputAssemblyCreateInfo.topology			   = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 
-	VkViewport viewport{};
-	viewport.x		  = 0.0F;
-	viewport.y		  = 0.0F;
-	viewport.height	  = static_cast<float>(extent.height);
-	viewport.width	  = static_cast<float>(extent.width);
-	viewport.minDepth = 0.0F;
-	viewport.maxDepth = 0.0F;
-
-	VkRect2D scissor{};
-	scissor.offset = {0, 0};
-	scissor.extent = extent;
-
 	VkPipelineViewportStateCreateInfo viewportCreateInfo{};
 	viewportCreateInfo.sType		 = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
 	viewportCreateInfo.scissorCount	 = 1;
@@ -307,22 +472,27 @@ void Pipeline::setup(const VkExtent2D &extent) {
 	depthStencilCreateInfo.front				 = {}; // Optional
 	depthStencilCreateInfo.back					 = {}; // Optional
 
-	VkPipelineLayoutCreateInfo pipelineCreateInfo{};
-	pipelineCreateInfo.sType				  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	pipelineCreateInfo.setLayoutCount		  = 1;
-	pipelineCreateInfo.pSetLayouts			  = &descriptorSetLayout;
-	pipelineCreateInfo.pushConstantRangeCount = 0;
-	pipelineCreateInfo.pPushConstantRanges	  = nullptr;
-
-	if (vkCreatePipelineLayout(device, &pipelineCreateInfo, nullptr, &layout) != VK_SUCCESS) {
-		throw std::runtime_error("couldn't create pipeline layout for current device");
-	}
-
-	std::cerr << "Created successfully pipeline layout for current device" << std::endl;
-
-	std::vector<VkPipelineShaderStageCreateInfo> stages;
-	for (const auto &[stageName, data] : shaders) {
-		stages.push_back(*data.stage);
+	// Fragment shader constants, by constant_id: the sampler array has to match the descriptor count of binding 1
+	struct FragmentConstants {
+		uint32_t textureSlots;
+		VkBool32 textured;
+	};
+	const FragmentConstants			constants{textureSlots, variant.textured ? VK_TRUE : VK_FALSE};
+	const std::array				constantEntries{
+		   VkSpecializationMapEntry{0, offsetof(FragmentConstants, textureSlots), sizeof(FragmentConstants::textureSlots)},
+		   VkSpecializationMapEntry{1, offsetof(FragmentConstants, textured), sizeof(FragmentConstants::textured)},
+	   };
+
+	VkSpecializationInfo fragmentSpecialization{};
+	fragmentSpecialization.mapEntryCount = constantEntries.size();
+	fragmentSpecialization.pMapEntries	 = constantEntries.data();
+	fragmentSpecialization.dataSize		 = sizeof(constants);
+	fragmentSpecialization.pData		 = &constants;
+
+	std::vector stages(shaderStages);
+	for (auto &stage : stages) {
+		if (stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT)
+			stage.pSpecializationInfo = &fragmentSpecialization;
 	}
 
 	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo{};
@@ -343,11 +513,141 @@ void Pipeline::setup(const VkExtent2D &extent) {
 	graphicsPipelineCreateInfo.basePipelineHandle  = VK_NULL_HANDLE;
 	graphicsPipelineCreateInfo.basePipelineIndex   = -1;
 
-	if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
+	VkPipeline ret;
+	if (vkCreateGraphicsPipelines(device, cache, 1, &graphicsPipelineCreateInfo, nullptr, &ret) != VK_SUCCESS) {
 		throw std::runtime_error("couldn't create graphics pipeline for current device");
 	}
 
-	std::cerr << "Created successfully a graphics pipeline for the current device" << std::endl;
+	std::cerr << "Created successfully a " << (variant.textured ? "textured" : "untextured") << " graphics pipeline for the current device"
+			  << std::endl;
+	return ret;
+}
+
+auto Pipeline::vertex_attributes() const -> std::vector<VkVertexInputAttributeDescription> {
+	// Only what the shader reads is fed, in the format it reads it with. Rebuilt shaders keep the same inputs, so the
+	// current vertex shader tells for them too.
+	std::vector<VkVertexInputAttributeDescription> ret;
+	const auto									   available = VertexData::getAttributeDescs();
+	for (const auto &input : shaders.at("vertex").reflection->inputs) {
+		// Matrices are fed column by column, from consecutive locations
+		auto column	   = input;
+		column.columns = 1;
+		for (uint32_t location = input.location; location < input.location + input.columns; location++) {
+			const auto attribute = std::ranges::find(available, location, &VkVertexInputAttributeDescription::location);
+			if (attribute == available.end())
+				throw std::runtime_error("vertex shader reads location " + std::to_string(location) + ", which vertices don't provide");
+			if (attribute->format != input_format(column))
+				throw std::runtime_error("vertex shader reads location " + std::to_string(location) + " with another format than vertices provide");
+			ret.push_back(*attribute);
+		}
+	}
+	return ret;
+}
+
+auto Pipeline::current_stages() const -> std::vector<VkPipelineShaderStageCreateInfo> {
+	std::vector<VkPipelineShaderStageCreateInfo> stages;
+	for (const auto &[stageName, data] : shaders) {
+		stages.push_back(*data.stage);
+	}
+	return stages;
+}
+
+auto Pipeline::rebuild(const std::string &stage_name, std::shared_ptr<resources::Shader> shader, const std::vector<PipelineVariant> &variants) const
+	-> Replacement {
+	Replacement replacement{stage_name, ShaderData(std::move(shader)), {}};
+	setup_shader_module(device, stage_name, replacement.data);
+
+	if (replacement.data.reflection != shaders.at(stage_name).reflection) {
+		vkDestroyShaderModule(device, *replacement.data.module, nullptr);
+		throw std::runtime_error(stage_name + " shader changed its interface, restart to apply it");
+	}
+
+	auto stages = current_stages();
+	for (auto &stage : stages) {
+		if (stage.stage == replacement.data.stage->stage)
+			stage = *replacement.data.stage;
+	}
+
+	try {
+		for (const auto &variant : variants)
+			replacement.pipelines[variant] = create_graphics_pipeline(stages, variant, cache);
+	} catch (...) {
+		for (const auto &[variant, pipeline] : replacement.pipelines)
+			vkDestroyPipeline(device, pipeline, nullptr);
+		vkDestroyShaderModule(device, *replacement.data.module, nullptr);
+		throw;
+	}
+	return replacement;
+}
+
+auto Pipeline::replace(Replacement replacement) -> std::pair<std::vector<VkPipeline>, VkShaderModule> {
+	auto					&data = shaders.at(replacement.stage);
+	std::vector<VkPipeline> old;
+	for (const auto &[variant, pipeline] : pipelines)
+		old.push_back(pipeline);
+	const auto oldModule = data.module.value_or(VK_NULL_HANDLE);
+
+	data	  = std::move(replacement.data);
+	pipelines = std::move(replacement.pipelines);
+	return {std::move(old), oldModule};
+}
+
+ComputePipeline::ComputePipeline(VkDevice &device, std::shared_ptr<resources::Shader> shader) : shader(std::move(shader)), device(device) {
+}
+
+ComputePipeline::~ComputePipeline() {
+	vkDestroyPipeline(device, pipeline, nullptr);
+	vkDestroyPipelineLayout(device, layout, nullptr);
+	vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+	if (shader.module)
+		vkDestroyShaderModule(device, *shader.module, nullptr);
+}
+
+void ComputePipeline::setup(const VkPipelineCache cache) {
+	if (!shader.resource->is_compiled())
+		throw std::runtime_error("couldn't compile compute shader:\n" + shader.resource->errors());
+	Pipeline::setup_shader_module(device, "compute", shader);
+
+	bindings.clear();
+	for (const auto &binding : shader.reflection->bindings) {
+		if (binding.set != 0)
+			throw std::runtime_error("compute shader uses descriptor set " + std::to_string(binding.set) + ", only set 0 is bound");
+		if (binding.count == 0)
+			throw std::runtime_error("compute shader uses a runtime sized array at binding " + std::to_string(binding.binding));
+		bindings.push_back({binding.binding, descriptor_type(binding.type), binding.count, VK_SHADER_STAGE_COMPUTE_BIT, nullptr});
+	}
+
+	VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo{};
+	setLayoutCreateInfo.sType		 = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	setLayoutCreateInfo.bindingCount = bindings.size();
+	setLayoutCreateInfo.pBindings	 = bindings.data();
+	if (vkCreateDescriptorSetLayout(device, &setLayoutCreateInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("couldn't create compute descriptor set layout");
+	}
+
+	const VkPushConstantRange  pushConstantRange{VK_SHADER_STAGE_COMPUTE_BIT, 0, shader.reflection->pushConstantSize};
+	VkPipelineLayoutCreateInfo layoutCreateInfo{};
+	layoutCreateInfo.sType					= VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutCreateInfo.setLayoutCount			= 1;
+	layoutCreateInfo.pSetLayouts			= &descriptorSetLayout;
+	layoutCreateInfo.pushConstantRangeCount = pushConstantRange.size ? 1 : 0;
+	layoutCreateInfo.pPushConstantRanges	= &pushConstantRange;
+	if (vkCreatePipelineLayout(device, &layoutCreateInfo, nullptr, &layout) != VK_SUCCESS) {
+		throw std::runtime_error("couldn't create compute pipeline layout");
+	}
+
+	VkComputePipelineCreateInfo createInfo{};
+	createInfo.sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	createInfo.stage  = *shader.stage;
+	createInfo.layout = layout;
+	if (vkCreateComputePipelines(device, cache, 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS) {
+		throw std::runtime_error("couldn't create compute pipeline");
+	}
+	std::cerr << "Created successfully compute pipeline for " << shader.resource->path() << std::endl;
+}
+
+auto ComputePipeline::descriptor_pool_sizes(const uint32_t setCount) const -> std::vector<VkDescriptorPoolSize> {
+	return pool_sizes(bindings, setCount);
 }
 
 } // namespace graphics
@@ -0,0 +1,108 @@
+#include "graphics/pipeline_cache.h"
+
+#include "assets/cache_files.h"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace graphics {
+
+namespace {
+
+constexpr std::array<char, 8> CACHE_MAGIC{'S', 'C', 'O', 'P', 'P', 'S', 'O', '\0'};
+
+// Prepended to the driver's data: its own header has no driver version, which the UUID isn't guaranteed to cover
+struct Header {
+	std::array<char, 8> magic;
+	uint32_t			driverVersion;
+	uint32_t			reserved;
+	uint64_t			size;
+};
+
+// Whether `data`, as returned by vkGetPipelineCacheData, was produced by the device described by `props`
+bool matches_device(const std::vector<char> &data, const VkPhysicalDeviceProperties &props) {
+	VkPipelineCacheHeaderVersionOne header{};
+	if (data.size() < sizeof(header))
+		return false;
+	std::memcpy(&header, data.data(), sizeof(header));
+
+	return header.headerSize >= sizeof(header) && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE && header.vendorID == props.vendorID &&
+		   header.deviceID == props.deviceID && std::memcmp(header.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+} // namespace
+
+PipelineCache::PipelineCache(const VkDevice device, const VkPhysicalDevice &physical, const std::filesystem::path &directory) : _device(device) {
+	vkGetPhysicalDeviceProperties(physical, &_properties);
+
+	if (!directory.empty()) {
+		std::ostringstream name;
+		name << std::hex << _properties.vendorID << '-' << _properties.deviceID << ".bin";
+		_path = directory / name.str();
+	}
+
+	std::vector<char> data;
+	if (std::ifstream ifs(_path, std::ios::binary); !_path.empty() && ifs) {
+		Header header{};
+		if (ifs.read(reinterpret_cast<char *>(&header), sizeof(header)) && header.magic == CACHE_MAGIC &&
+			header.driverVersion == _properties.driverVersion && header.size <= assets::cache_files::remaining(ifs)) {
+			data.resize(header.size);
+			if (!ifs.read(data.data(), static_cast<std::streamsize>(data.size())) || !matches_device(data, _properties))
+				data.clear();
+		}
+	}
+
+	VkPipelineCacheCreateInfo createInfo{};
+	createInfo.sType		   = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	createInfo.initialDataSize = data.size();
+	createInfo.pInitialData	   = data.empty() ? nullptr : data.data();
+
+	if (vkCreatePipelineCache(_device, &createInfo, nullptr, &_cache) != VK_SUCCESS) {
+		throw std::runtime_error("couldn't create pipeline cache");
+	}
+	std::cerr << "Created successfully pipeline cache with " << data.size() << " bytes of previous runs" << std::endl;
+}
+
+PipelineCache::~PipelineCache() {
+	save();
+	vkDestroyPipelineCache(_device, _cache, nullptr);
+}
+
+void PipelineCache::save() const {
+	if (_path.empty())
+		return;
+
+	size_t size = 0;
+	if (vkGetPipelineCacheData(_device, _cache, &size, nullptr) != VK_SUCCESS || size == 0)
+		return;
+	std::vector<char> data(size);
+	if (vkGetPipelineCacheData(_device, _cache, &size, data.data()) != VK_SUCCESS)
+		return;
+	data.resize(size);
+
+	const Header header{
+		.magic		   = CACHE_MAGIC,
+		.driverVersion = _properties.driverVersion,
+		.reserved	   = 0,
+		.size		   = data.size(),
+	};
+	assets::cache_files::write(_path, "pipeline cache", [&](std::ostream &os) {
+		os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		os.write(data.data(), static_cast<std::streamsize>(data.size()));
+	});
+}
+
+PipelineCache::operator VkPipelineCache() const {
+	return _cache;
+}
+
+std::filesystem::path PipelineCache::default_directory() {
+	return assets::cache_files::default_directory("pipelines");
+}
+
+} // namespace graphics
@@ -19,6 +19,9 @@ QueueFamilyIndices::operator std::set<uint32_t>() const {
 	if (presentFamily.has_value())
 		result.insert(presentFamily.value());
 
+	if (computeFamily.has_value())
+		result.insert(computeFamily.value());
+
 	return result;
 }
 
@@ -36,13 +39,19 @@ QueueFamilyIndices graphics::find_queue_families(VkPhysicalDevice physicalDevice
 	for (const auto &queueFamily : queueFamilies) {
 		if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
 			indices.graphicsFamily = i;
+		if (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT && (!indices.computeFamily || indices.graphicsFamily == i))
+			indices.computeFamily = i;
 
+		// Without a surface nothing is presented, the graphics queue stands in for the present one
 		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
+		if (surface != VK_NULL_HANDLE)
+			vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
 		if (presentSupport)
 			indices.presentFamily = i;
+		else if (surface == VK_NULL_HANDLE)
+			indices.presentFamily = indices.graphicsFamily;
 
-		if (indices)
+		if (indices && indices.computeFamily == indices.graphicsFamily)
 			return indices;
 
 		i++;
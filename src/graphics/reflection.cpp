@@ -0,0 +1,361 @@
+#include "graphics/reflection.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace graphics::resources {
+
+namespace {
+
+constexpr uint32_t SPIRV_MAGIC		 = 0x07230203;
+constexpr size_t   SPIRV_HEADER_SIZE = 5;
+
+// The subset of the SPIR-V grammar describing a module's interface
+enum Op : uint16_t {
+	OP_ENTRY_POINT		   = 15,
+	OP_TYPE_BOOL		   = 20,
+	OP_TYPE_INT			   = 21,
+	OP_TYPE_FLOAT		   = 22,
+	OP_TYPE_VECTOR		   = 23,
+	OP_TYPE_MATRIX		   = 24,
+	OP_TYPE_IMAGE		   = 25,
+	OP_TYPE_SAMPLER		   = 26,
+	OP_TYPE_SAMPLED_IMAGE  = 27,
+	OP_TYPE_ARRAY		   = 28,
+	OP_TYPE_RUNTIME_ARRAY  = 29,
+	OP_TYPE_STRUCT		   = 30,
+	OP_TYPE_POINTER		   = 32,
+	OP_CONSTANT			   = 43,
+	OP_SPEC_CONSTANT_TRUE  = 48,
+	OP_SPEC_CONSTANT_FALSE = 49,
+	OP_SPEC_CONSTANT	   = 50,
+	OP_VARIABLE			   = 59,
+	OP_DECORATE			   = 71,
+	OP_MEMBER_DECORATE	   = 72,
+};
+
+enum Decoration : uint32_t {
+	SPEC_ID		  = 1,
+	BLOCK		  = 2,
+	BUFFER_BLOCK  = 3,
+	ARRAY_STRIDE  = 6,
+	MATRIX_STRIDE = 7,
+	BUILT_IN	  = 11,
+	LOCATION	  = 30,
+	BINDING		  = 33,
+	SET			  = 34,
+	OFFSET		  = 35,
+};
+
+enum StorageClass : uint32_t {
+	UNIFORM_CONSTANT = 0,
+	INPUT			 = 1,
+	UNIFORM			 = 2,
+	PUSH_CONSTANT	 = 9,
+	STORAGE_BUFFER	 = 12,
+};
+
+enum ExecutionModel : uint32_t {
+	VERTEX	 = 0,
+	FRAGMENT = 4,
+	COMPUTE	 = 5,
+};
+
+constexpr uint32_t DIM_BUFFER		= 5;
+constexpr uint32_t DIM_SUBPASS_DATA = 6;
+
+struct Instruction {
+	Op					  op;
+	// Operands following the result id
+	std::vector<uint32_t> operands;
+};
+
+// Decoration -> its first literal, 0 for the ones without
+using Decorations = std::unordered_map<uint32_t, uint32_t>;
+
+struct Module {
+	std::unordered_map<uint32_t, Instruction>						   types;
+	std::unordered_map<uint32_t, Instruction>						   constants;
+	std::unordered_map<uint32_t, Decorations>						   decorations;
+	std::unordered_map<uint32_t, std::unordered_map<uint32_t, Decorations>> memberDecorations;
+	// Result id, pointer type and storage class of every global variable
+	std::vector<std::tuple<uint32_t, uint32_t, uint32_t>>			   variables;
+	std::optional<uint32_t>											   executionModel;
+
+	[[nodiscard]] const Instruction &type(const uint32_t id) const {
+		const auto it = types.find(id);
+		if (it == types.end())
+			throw std::runtime_error("SPIR-V: undefined type %" + std::to_string(id));
+		return it->second;
+	}
+
+	[[nodiscard]] std::optional<uint32_t> decoration(const uint32_t id, const Decoration decoration) const {
+		const auto it = decorations.find(id);
+		if (it == decorations.end())
+			return std::nullopt;
+		const auto found = it->second.find(decoration);
+		return found == it->second.end() ? std::nullopt : std::optional(found->second);
+	}
+
+	[[nodiscard]] std::optional<uint32_t> member_decoration(const uint32_t id, const uint32_t member, const Decoration decoration) const {
+		const auto it = memberDecorations.find(id);
+		if (it == memberDecorations.end())
+			return std::nullopt;
+		const auto decorations = it->second.find(member);
+		if (decorations == it->second.end())
+			return std::nullopt;
+		const auto found = decorations->second.find(decoration);
+		return found == decorations->second.end() ? std::nullopt : std::optional(found->second);
+	}
+};
+
+Module parse(const std::vector<uint32_t> &spirv) {
+	if (spirv.size() < SPIRV_HEADER_SIZE || spirv[0] != SPIRV_MAGIC)
+		throw std::runtime_error("SPIR-V: invalid header");
+
+	Module module;
+	for (size_t i = SPIRV_HEADER_SIZE; i < spirv.size();) {
+		const uint32_t wordCount = spirv[i] >> 16;
+		const auto	   op		 = static_cast<Op>(spirv[i] & 0xffff);
+		if (wordCount == 0 || i + wordCount > spirv.size())
+			throw std::runtime_error("SPIR-V: truncated instruction");
+
+		const uint32_t *words = spirv.data() + i + 1;
+		const uint32_t	count = wordCount - 1;
+		i					 += wordCount;
+
+		switch (op) {
+		case OP_ENTRY_POINT:
+			if (!module.executionModel && count >= 1)
+				module.executionModel = words[0];
+			break;
+		case OP_TYPE_BOOL:
+		case OP_TYPE_INT:
+		case OP_TYPE_FLOAT:
+		case OP_TYPE_VECTOR:
+		case OP_TYPE_MATRIX:
+		case OP_TYPE_IMAGE:
+		case OP_TYPE_SAMPLER:
+		case OP_TYPE_SAMPLED_IMAGE:
+		case OP_TYPE_ARRAY:
+		case OP_TYPE_RUNTIME_ARRAY:
+		case OP_TYPE_STRUCT:
+		case OP_TYPE_POINTER:
+			if (count >= 1)
+				module.types[words[0]] = {op, {words + 1, words + count}};
+			break;
+		case OP_CONSTANT:
+		case OP_SPEC_CONSTANT:
+		case OP_SPEC_CONSTANT_TRUE:
+		case OP_SPEC_CONSTANT_FALSE:
+			// Result type first, then the result id
+			if (count >= 2)
+				module.constants[words[1]] = {op, {words + 2, words + count}};
+			break;
+		case OP_VARIABLE:
+			if (count >= 3)
+				module.variables.emplace_back(words[1], words[0], words[2]);
+			break;
+		case OP_DECORATE:
+			if (count >= 2)
+				module.decorations[words[0]][words[1]] = count >= 3 ? words[2] : 0;
+			break;
+		case OP_MEMBER_DECORATE:
+			if (count >= 3)
+				module.memberDecorations[words[0]][words[1]][words[2]] = count >= 4 ? words[3] : 0;
+			break;
+		default:
+			break;
+		}
+	}
+
+	return module;
+}
+
+// Value of an integer constant, with the constant_id of specialization constants
+std::pair<uint32_t, std::optional<uint32_t>> constant_value(const Module &module, const uint32_t id) {
+	const auto it = module.constants.find(id);
+	if (it == module.constants.end() || it->second.operands.empty())
+		throw std::runtime_error("SPIR-V: array length %" + std::to_string(id) + " isn't a plain or specialization constant");
+
+	const auto &[op, operands] = it->second;
+	if (op == OP_SPEC_CONSTANT)
+		return {operands[0], module.decoration(id, SPEC_ID)};
+	return {operands[0], std::nullopt};
+}
+
+// Size in bytes of a type laid out in a block, following its explicit layout decorations
+uint32_t size_of(const Module &module, const uint32_t id, const std::optional<uint32_t> matrixStride = std::nullopt) {
+	const auto &[op, operands] = module.type(id);
+
+	switch (op) {
+	case OP_TYPE_BOOL:
+		return 4;
+	case OP_TYPE_INT:
+	case OP_TYPE_FLOAT:
+		return operands.at(0) / 8;
+	case OP_TYPE_VECTOR:
+		return operands.at(1) * size_of(module, operands.at(0));
+	case OP_TYPE_MATRIX:
+		return operands.at(1) * matrixStride.value_or(size_of(module, operands.at(0)));
+	case OP_TYPE_ARRAY: {
+		const auto stride = module.decoration(id, ARRAY_STRIDE);
+		return constant_value(module, operands.at(1)).first * stride.value_or(size_of(module, operands.at(0)));
+	}
+	case OP_TYPE_STRUCT: {
+		uint32_t size = 0;
+		for (uint32_t member = 0; member < operands.size(); member++) {
+			const uint32_t offset = module.member_decoration(id, member, OFFSET).value_or(size);
+			size = std::max(size, offset + size_of(module, operands[member], module.member_decoration(id, member, MATRIX_STRIDE)));
+		}
+		return size;
+	}
+	default:
+		throw std::runtime_error("SPIR-V: type %" + std::to_string(id) + " has no size in a block");
+	}
+}
+
+ShaderReflection::DescriptorType descriptor_type(const Module &module, const uint32_t id, const uint32_t storage) {
+	using Type = ShaderReflection::DescriptorType;
+
+	const auto &[op, operands] = module.type(id);
+
+	if (storage == STORAGE_BUFFER)
+		return Type::STORAGE_BUFFER;
+	if (storage == UNIFORM)
+		return module.decoration(id, BUFFER_BLOCK) ? Type::STORAGE_BUFFER : Type::UNIFORM_BUFFER;
+
+	switch (op) {
+	case OP_TYPE_SAMPLED_IMAGE:
+		return Type::COMBINED_IMAGE_SAMPLER;
+	case OP_TYPE_SAMPLER:
+		return Type::SAMPLER;
+	case OP_TYPE_IMAGE: {
+		// Sampled type, dim, depth, arrayed, multisampled, sampled
+		const uint32_t dim	   = operands.at(1);
+		const uint32_t sampled = operands.at(5);
+		if (dim == DIM_SUBPASS_DATA)
+			return Type::INPUT_ATTACHMENT;
+		if (dim == DIM_BUFFER)
+			return sampled == 2 ? Type::STORAGE_TEXEL_BUFFER : Type::UNIFORM_TEXEL_BUFFER;
+		return sampled == 2 ? Type::STORAGE_IMAGE : Type::SAMPLED_IMAGE;
+	}
+	default:
+		throw std::runtime_error("SPIR-V: unsupported resource type %" + std::to_string(id));
+	}
+}
+
+ShaderReflection::Binding reflect_binding(const Module &module, const uint32_t variable, uint32_t type, const uint32_t storage) {
+	ShaderReflection::Binding binding{
+		.set		 = module.decoration(variable, SET).value_or(0),
+		.binding	 = module.decoration(variable, BINDING).value_or(0),
+		.type		 = ShaderReflection::DescriptorType::UNIFORM_BUFFER,
+		.count		 = 1,
+		.countSpecId = std::nullopt,
+	};
+
+	for (const Instruction *it; (it = &module.type(type))->op == OP_TYPE_ARRAY || it->op == OP_TYPE_RUNTIME_ARRAY;) {
+		if (it->op == OP_TYPE_RUNTIME_ARRAY) {
+			binding.count = 0;
+		} else {
+			const auto [length, specId] = constant_value(module, it->operands.at(1));
+			if (specId && binding.countSpecId)
+				throw std::runtime_error("SPIR-V: nested arrays sized by specialization constants aren't supported");
+			binding.count		*= length;
+			binding.countSpecId	 = specId ? specId : binding.countSpecId;
+		}
+		type = it->operands.at(0);
+	}
+
+	binding.type = descriptor_type(module, type, storage);
+	return binding;
+}
+
+std::optional<ShaderReflection::Input> reflect_input(const Module &module, const uint32_t variable, const uint32_t type) {
+	const auto location = module.decoration(variable, LOCATION);
+	if (!location || module.decoration(variable, BUILT_IN))
+		return std::nullopt;
+
+	ShaderReflection::Input input{
+		.location	= *location,
+		.type		= ShaderReflection::ScalarType::FLOAT,
+		.width		= 0,
+		.components = 1,
+		.columns	= 1,
+	};
+
+	const Instruction *it = &module.type(type);
+	if (it->op == OP_TYPE_MATRIX) {
+		input.columns = it->operands.at(1);
+		it			  = &module.type(it->operands.at(0));
+	}
+	if (it->op == OP_TYPE_VECTOR) {
+		input.components = it->operands.at(1);
+		it				 = &module.type(it->operands.at(0));
+	}
+
+	if (it->op == OP_TYPE_FLOAT) {
+		input.width = it->operands.at(0);
+	} else if (it->op == OP_TYPE_INT) {
+		input.width = it->operands.at(0);
+		input.type	= it->operands.at(1) ? ShaderReflection::ScalarType::SINT : ShaderReflection::ScalarType::UINT;
+	} else {
+		throw std::runtime_error("SPIR-V: unsupported type for input at location " + std::to_string(*location));
+	}
+
+	return input;
+}
+
+} // namespace
+
+ShaderReflection reflect(const std::vector<uint32_t> &spirv) {
+	const auto		 module = parse(spirv);
+	ShaderReflection reflection;
+
+	switch (module.executionModel.value_or(~0u)) {
+	case VERTEX:
+		reflection.stage = ShaderReflection::Stage::VERTEX;
+		break;
+	case FRAGMENT:
+		reflection.stage = ShaderReflection::Stage::FRAGMENT;
+		break;
+	case COMPUTE:
+		reflection.stage = ShaderReflection::Stage::COMPUTE;
+		break;
+	default:
+		reflection.stage = ShaderReflection::Stage::OTHER;
+		break;
+	}
+
+	for (const auto &[variable, pointer, storage] : module.variables) {
+		const auto &pointerType = module.type(pointer);
+		if (pointerType.op != OP_TYPE_POINTER)
+			throw std::runtime_error("SPIR-V: variable %" + std::to_string(variable) + " isn't a pointer");
+		const uint32_t type = pointerType.operands.at(1);
+
+		switch (storage) {
+		case UNIFORM_CONSTANT:
+		case UNIFORM:
+		case STORAGE_BUFFER:
+			reflection.bindings.push_back(reflect_binding(module, variable, type, storage));
+			break;
+		case PUSH_CONSTANT:
+			reflection.pushConstantSize = std::max(reflection.pushConstantSize, size_of(module, type));
+			break;
+		case INPUT:
+			if (const auto input = reflect_input(module, variable, type))
+				reflection.inputs.push_back(*input);
+			break;
+		default:
+			break;
+		}
+	}
+
+	std::ranges::sort(reflection.bindings);
+	std::ranges::sort(reflection.inputs);
+	return reflection;
+}
+
+} // namespace graphics::resources
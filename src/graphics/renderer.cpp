@@ -14,7 +14,9 @@
 namespace graphics {
 
 Renderer::Renderer(VulkanInstance *instance, GLFWwindow *window) : _instance(instance), _window(window), _surface() {
-	init_surface();
+	// Headless renderers have no window, so no surface either
+	if (_window)
+		init_surface();
 }
 
 void Renderer::init_surface() {
@@ -47,17 +49,39 @@ void Renderer::acquire_queues(const QueueFamilyIndices &indices) {
 
 void Renderer::render(const VkPhysicalDevice physical, const uint32_t frame_idx) const {
 	const VkDevice		  &device				   = _instance->_device;
-	const VkCommandBuffer &commandBuffer		   = _instance->_commandBuffers[frame_idx];
+	const VkCommandBuffer &uploadCommandBuffer	   = _instance->_uploadCommandBuffers[frame_idx];
 	const VkFence		  &inFlightFence		   = _instance->_inFlightFences[frame_idx];
 	const VkSemaphore	  &imageAvailableSemaphore = _instance->_imageAvailableSemaphores[frame_idx];
 	const VkSemaphore	  &renderFinishedSemaphore = _instance->_renderFinishedSemaphores[frame_idx];
+	FrameProfiler		  &profiler				   = _instance->_profiler;
 
-	vkWaitForFences(device, 1, &inFlightFence, VK_TRUE, UINT64_MAX);
+	using Scope = FrameProfiler::Scope;
 
-	uint32_t img_idx;
+	const bool latency = _instance->_framePacing == FramePacing::LATENCY;
+
+	profiler.begin_frame();
+	if (!latency)
+		poll_events();
 	{
-		// ReSharper disable once CppTooWideScopeInitStatement
-		const VkResult res = vkAcquireNextImageKHR(device, _instance->_swapchain, UINT64_MAX, imageAvailableSemaphore, VK_NULL_HANDLE, &img_idx);
+		// Paced for latency, every frame in flight is waited on: the GPU is then idle and this frame queued behind nothing
+		const FrameProfiler::Timer timer(profiler, Scope::FENCE_WAIT);
+		if (latency)
+			vkWaitForFences(device, _instance->_inFlightFences.size(), _instance->_inFlightFences.data(), VK_TRUE, UINT64_MAX);
+		else
+			vkWaitForFences(device, 1, &inFlightFence, VK_TRUE, UINT64_MAX);
+	}
+	// The fence covers the timestamps this frame slot wrote last time
+	_instance->_gpuProfiler->collect(frame_idx, profiler);
+	_instance->reload_shaders();
+
+	// Offscreen images are per frame in flight, guarded by the same fence
+	uint32_t img_idx = frame_idx;
+	if (!_instance->headless()) {
+		VkResult res;
+		{
+			const FrameProfiler::Timer timer(profiler, Scope::ACQUIRE);
+			res = vkAcquireNextImageKHR(device, _instance->_swapchain, UINT64_MAX, imageAvailableSemaphore, VK_NULL_HANDLE, &img_idx);
+		}
 
 		if (res == VK_ERROR_OUT_OF_DATE_KHR) {
 			std::cerr << "SWAPCHAIN INVALID, RECREATING IT" << std::endl;
@@ -69,30 +93,54 @@ void Renderer::render(const VkPhysicalDevice physical, const uint32_t frame_idx)
 		}
 	}
 
-	vkResetFences(device, 1, &inFlightFence);
-	vkResetCommandBuffer(commandBuffer, 0);
-	_instance->record_command_buffer(commandBuffer, img_idx, frame_idx);
+	// Once the image to draw into is there, so that nothing but recording separates the input from the frame showing it
+	if (latency)
+		poll_events();
 
-	updateUniformBuffer(frame_idx);
+	vkResetFences(device, 1, &inFlightFence);
+	VkCommandBuffer commandBuffer;
+	{
+		const FrameProfiler::Timer timer(profiler, Scope::RECORD);
+		vkResetCommandBuffer(uploadCommandBuffer, 0);
+
+		// Texture residency follows this frame's camera, its uploads run ahead of the draws in the same submission
+		const auto view = updateUniformBuffer(frame_idx);
+		{
+			const FrameProfiler::Timer cullTimer(profiler, Scope::CULL);
+			_instance->cull(frame_idx, view);
+		}
+		_instance->stream_textures(physical, frame_idx, view);
+		// After culling and streaming, which may have left this frame's command buffer stale
+		commandBuffer = _instance->frame_command_buffer(img_idx, frame_idx);
+	}
 
+	const std::array							  commandBuffers{uploadCommandBuffer, commandBuffer};
 	const std::array							  waitSemaphore{imageAvailableSemaphore};
 	constexpr std::array<VkPipelineStageFlags, 1> waitPipelineStages{VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
 	const std::array							  signalSemaphore{renderFinishedSemaphore};
+	// Nothing to wait for nor to signal without a swapchain, the fence alone orders frames
+	const uint32_t								  semaphoreCount = _instance->headless() ? 0 : 1;
 
 	VkSubmitInfo								  submitInfo{};
 	submitInfo.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submitInfo.waitSemaphoreCount	= waitSemaphore.size();
+	submitInfo.waitSemaphoreCount	= semaphoreCount;
 	submitInfo.pWaitSemaphores		= waitSemaphore.data();
 	submitInfo.pWaitDstStageMask	= waitPipelineStages.data();
-	submitInfo.commandBufferCount	= 1;
-	submitInfo.pCommandBuffers		= &commandBuffer;
-	submitInfo.signalSemaphoreCount = signalSemaphore.size();
+	submitInfo.commandBufferCount	= commandBuffers.size();
+	submitInfo.pCommandBuffers		= commandBuffers.data();
+	submitInfo.signalSemaphoreCount = semaphoreCount;
 	submitInfo.pSignalSemaphores	= signalSemaphore.data();
 
-	if (vkQueueSubmit(_graphics, 1, &submitInfo, inFlightFence) != VK_SUCCESS) {
-		throw std::runtime_error("couldn't submit graphics queue");
+	{
+		const FrameProfiler::Timer timer(profiler, Scope::SUBMIT);
+		if (vkQueueSubmit(_graphics, 1, &submitInfo, inFlightFence) != VK_SUCCESS) {
+			throw std::runtime_error("couldn't submit graphics queue");
+		}
 	}
 
+	if (_instance->headless())
+		return;
+
 	const std::array swapchains{_instance->_swapchain};
 	VkPresentInfoKHR presentInfo{};
 	presentInfo.sType			   = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -105,8 +153,11 @@ void Renderer::render(const VkPhysicalDevice physical, const uint32_t frame_idx)
 
 
 	{
-		// ReSharper disable once CppTooWideScopeInitStatement
-		const VkResult res = vkQueuePresentKHR(_present, &presentInfo);
+		VkResult res;
+		{
+			const FrameProfiler::Timer timer(profiler, Scope::PRESENT);
+			res = vkQueuePresentKHR(_present, &presentInfo);
+		}
 
 		if (res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR || _instance->_framebufferResized) {
 			std::cerr << "SWAPCHAIN INVALID, RECREATING IT" << std::endl;
@@ -118,27 +169,43 @@ void Renderer::render(const VkPhysicalDevice physical, const uint32_t frame_idx)
 	}
 }
 
-void Renderer::updateUniformBuffer(uint32_t frame_idx) const {
+void Renderer::poll_events() const {
+	if (_window)
+		glfwPollEvents();
+}
+
+SceneView Renderer::updateUniformBuffer(uint32_t frame_idx) const {
 	const static auto	start_time	 = std::chrono::high_resolution_clock::now();
 
 	const auto			current_time = std::chrono::high_resolution_clock::now();
-	const float			elapsed		 = std::chrono::duration<float, std::chrono::seconds::period>(current_time - start_time).count();
+	// Headless frames all show the model at rest, so that renders are reproducible
+	const float			elapsed		 = _instance->headless() ? 0.0f : std::chrono::duration<float, std::chrono::seconds::period>(current_time - start_time).count();
 	const float			ratio		 = _instance->_swapchainExtent.width / static_cast<float>(_instance->_swapchainExtent.height);
 
-	UniformBufferObject ubo{};
-	ubo.model = maths::Mat4::rotate(elapsed * maths::rad(30), maths::Vec3(0, 0, 1));
-	ubo.view  = maths::Mat4::lookAt(maths::Vec3(2.0f, 2.0f, 2.0f), maths::Vec3(0.0f, 0.0f, 0.0f), maths::Vec3(0.0f, 0.0f, 1.0f));
-	ubo.proj  = maths::Mat4::perspective(maths::rad(45), ratio, 0.1f, 10.0f);
+	SceneView			view;
+	view.model = maths::Mat4::rotate(elapsed * maths::rad(30), maths::Vec3(0, 0, 1));
+	view.view  = maths::Mat4::lookAt(maths::Vec3(2.0f, 2.0f, 2.0f), maths::Vec3(0.0f, 0.0f, 0.0f), maths::Vec3(0.0f, 0.0f, 1.0f));
+	view.proj  = maths::Mat4::perspective(maths::rad(45), ratio, 0.1f, 10.0f);
 
 	if constexpr (DEBUG && false) {
-		display_mat("model", ubo.model, 4, 4);
-		display_mat("view", ubo.view, 4, 4);
-		display_mat("proj", ubo.proj, 4, 4);
+		display_mat("model", view.model, 4, 4);
+		display_mat("view", view.view, 4, 4);
+		display_mat("proj", view.proj, 4, 4);
 	}
 
 
-	ubo.proj[1][1] *= -1;
-	memcpy(_instance->_uniformBuffersMapped[frame_idx], &ubo, sizeof ubo);
+	view.proj[1][1] *= -1;
+
+	// The frame's region of the ring, free since its fence was waited on
+	uint8_t *const		mapped = _instance->_uniformRingMapped;
+	const FrameUniforms frame{.viewProj = view.view * view.proj};
+	memcpy(mapped + _instance->frame_uniforms_offset(frame_idx), &frame, sizeof frame);
+	for (uint32_t i = 0; i < _instance->_objects.size(); i++) {
+		// Placed in the scene, then moved along with it
+		const ObjectUniforms object{.model = _instance->_objects[i].transform * view.model};
+		memcpy(mapped + _instance->object_uniforms_offset(frame_idx, i), &object, sizeof object);
+	}
+	return view;
 }
 
 
@@ -0,0 +1,85 @@
+#include "graphics/shader_cache.h"
+
+#include "assets/cache_files.h"
+
+#include <array>
+#include <fstream>
+#include <sstream>
+
+namespace graphics::resources {
+
+namespace {
+
+// Bump whenever the entry layout changes
+constexpr uint32_t			  CACHE_VERSION = 1;
+constexpr std::array<char, 8> CACHE_MAGIC{'S', 'C', 'O', 'P', 'S', 'P', 'V', '\0'};
+constexpr uint32_t			  SPIRV_MAGIC = 0x07230203;
+
+struct Header {
+	std::array<char, 8> magic;
+	uint32_t			version;
+	uint32_t			words;
+	uint64_t			keySize;
+};
+
+std::filesystem::path entry_path(const std::filesystem::path &directory, const std::string &key) {
+	std::ostringstream oss;
+	oss << std::hex << std::hash<std::string>{}(key) << ".spv";
+	return directory / oss.str();
+}
+
+} // namespace
+
+SpirvCache::SpirvCache(std::filesystem::path directory) : _directory(std::move(directory)) {
+}
+
+std::optional<std::vector<uint32_t>> SpirvCache::find(const std::string &key) const {
+	if (!enabled())
+		return std::nullopt;
+
+	std::ifstream ifs(entry_path(_directory, key), std::ios::binary);
+	Header		  header{};
+	if (!ifs.read(reinterpret_cast<char *>(&header), sizeof(header)))
+		return std::nullopt;
+	if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.keySize != key.size() || header.words == 0)
+		return std::nullopt;
+
+	std::string storedKey(header.keySize, '\0');
+	if (!ifs.read(storedKey.data(), static_cast<std::streamsize>(storedKey.size())) || storedKey != key)
+		return std::nullopt;
+
+	if (header.words > assets::cache_files::remaining(ifs) / sizeof(uint32_t))
+		return std::nullopt;
+	std::vector<uint32_t> spirv(header.words);
+	if (!ifs.read(reinterpret_cast<char *>(spirv.data()), static_cast<std::streamsize>(spirv.size() * sizeof(uint32_t))) || spirv[0] != SPIRV_MAGIC)
+		return std::nullopt;
+
+	return spirv;
+}
+
+void SpirvCache::store(const std::string &key, const std::vector<uint32_t> &spirv) const {
+	if (!enabled() || spirv.empty())
+		return;
+
+	const Header header{
+		.magic	 = CACHE_MAGIC,
+		.version = CACHE_VERSION,
+		.words	 = static_cast<uint32_t>(spirv.size()),
+		.keySize = key.size(),
+	};
+	assets::cache_files::write(entry_path(_directory, key), "shader cache entry", [&](std::ostream &os) {
+		os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		os.write(key.data(), static_cast<std::streamsize>(key.size()));
+		os.write(reinterpret_cast<const char *>(spirv.data()), static_cast<std::streamsize>(spirv.size() * sizeof(uint32_t)));
+	});
+}
+
+bool SpirvCache::enabled() const {
+	return !_directory.empty();
+}
+
+std::filesystem::path SpirvCache::default_directory() {
+	return assets::cache_files::default_directory("shaders");
+}
+
+} // namespace graphics::resources
@@ -0,0 +1,93 @@
+#include "graphics/vulkan.h"
+
+#include "application.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace graphics {
+
+void VulkanInstance::watch_shaders() {
+	std::vector<std::string> paths;
+	for (const auto &[stage_name, data] : _pipeline->shaders)
+		paths.push_back(data.resource->path());
+
+	_shaderWatcher = std::make_unique<resources::ShaderWatcher>(paths);
+}
+
+void VulkanInstance::reload_shaders() {
+	// Called once per frame, right after waiting on its fence
+	destroy_retired_pipelines(false);
+
+	if (!_shaderWatcher)
+		return;
+
+	for (const auto &path : _shaderWatcher->changed()) {
+		if (std::ranges::find(_staleShaders, path) == _staleShaders.end())
+			_staleShaders.push_back(path);
+	}
+
+	if (_pendingPipeline.valid()) {
+		if (_pendingPipeline.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return;
+
+		try {
+			auto	   replacement = _pendingPipeline.get();
+			const auto stage	   = replacement.stage;
+			auto [pipelines, module] = _pipeline->replace(std::move(replacement));
+			_retiredPipelines.push_back({std::move(pipelines), module, _framesInFlight});
+			invalidate_command_buffers();
+			std::cerr << "Reloaded " << stage << " shader" << std::endl;
+		} catch (const std::exception &e) {
+			// The current pipeline is kept, the shader is rebuilt on its next save
+			std::cerr << "couldn't reload shader: " << e.what() << std::endl;
+		}
+	}
+
+	if (_staleShaders.empty())
+		return;
+
+	const auto path	 = _staleShaders.front();
+	_staleShaders.erase(_staleShaders.begin());
+
+	const auto stage = std::ranges::find(_pipeline->shaders, path, [](const auto &entry) { return entry.second.resource->path(); });
+	if (stage == _pipeline->shaders.end())
+		return;
+
+	// Only reads the current shaders, which aren't replaced before this is done. Variants created in the meantime are
+	// dropped by the swap and created again from the new shaders.
+	_pendingPipeline = std::async(std::launch::async, [this, path, stageName = stage->first, defines = stage->second.resource->defines(),
+													   variants = _pipeline->variants()] {
+		auto shader = std::make_shared<resources::Shader>(path, defines);
+		if (!shader->compile(resources::SpirvCache()))
+			throw std::runtime_error(path + ": " + shader->errors());
+
+		return _pipeline->rebuild(stageName, std::move(shader), variants);
+	});
+}
+
+void VulkanInstance::destroy_retired_pipelines(const bool all) {
+	if (all && _pendingPipeline.valid()) {
+		try {
+			auto			   replacement = _pendingPipeline.get();
+			std::vector<VkPipeline> pipelines;
+			for (const auto &[variant, pipeline] : replacement.pipelines)
+				pipelines.push_back(pipeline);
+			_retiredPipelines.push_back({std::move(pipelines), replacement.data.module.value_or(VK_NULL_HANDLE), 0});
+		} catch (const std::exception &) {
+			// A failed rebuild leaves nothing behind
+		}
+	}
+
+	std::erase_if(_retiredPipelines, [this, all](RetiredPipeline &retired) {
+		if (!all && retired.framesLeft-- > 1)
+			return false;
+
+		for (const auto &pipeline : retired.pipelines)
+			vkDestroyPipeline(_device, pipeline, nullptr);
+		vkDestroyShaderModule(_device, retired.module, nullptr);
+		return true;
+	});
+}
+
+} // namespace graphics
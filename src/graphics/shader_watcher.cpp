@@ -0,0 +1,104 @@
+#include "graphics/shader_watcher.h"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+#ifdef __linux__
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace graphics::resources {
+
+namespace {
+
+std::filesystem::file_time_type mtime(const std::string &path) {
+	std::error_code ec;
+	const auto		time = std::filesystem::last_write_time(path, ec);
+	return ec ? std::filesystem::file_time_type::min() : time;
+}
+
+} // namespace
+
+ShaderWatcher::ShaderWatcher(const std::vector<std::string> &paths) : _paths(paths) {
+#ifdef __linux__
+	_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (_fd >= 0) {
+		for (const auto &path : _paths) {
+			auto directory = std::filesystem::path(path).parent_path();
+			if (directory.empty())
+				directory = ".";
+			if (std::ranges::find(_directories, directory, &decltype(_directories)::value_type::second) != _directories.end())
+				continue;
+
+			const int wd = inotify_add_watch(_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+			if (wd < 0) {
+				std::cerr << "warning: couldn't watch " << directory << " for shader changes: " << std::strerror(errno) << std::endl;
+				continue;
+			}
+			_directories.emplace(wd, directory);
+		}
+		std::cerr << "Watching " << _paths.size() << " shaders for changes" << std::endl;
+		return;
+	}
+	std::cerr << "warning: inotify unavailable, polling shaders for changes instead" << std::endl;
+#endif
+
+	std::ranges::transform(_paths, std::back_inserter(_mtimes), mtime);
+	_lastPoll = std::chrono::steady_clock::now();
+}
+
+ShaderWatcher::~ShaderWatcher() {
+#ifdef __linux__
+	if (_fd >= 0)
+		close(_fd);
+#endif
+}
+
+std::vector<std::string> ShaderWatcher::changed() {
+	std::vector<std::string> ret;
+
+#ifdef __linux__
+	if (_fd >= 0) {
+		alignas(inotify_event) std::array<char, 4096> buffer;
+
+		ssize_t										  len;
+		while ((len = read(_fd, buffer.data(), buffer.size())) > 0) {
+			for (ssize_t offset = 0; offset < len;) {
+				const auto *event  = reinterpret_cast<const inotify_event *>(buffer.data() + offset);
+				offset			  += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+				const auto directory = _directories.find(event->wd);
+				if (directory == _directories.end() || event->len == 0)
+					continue;
+
+				const auto file = directory->second / event->name;
+				for (const auto &path : _paths) {
+					std::error_code ec;
+					if (std::filesystem::equivalent(path, file, ec) && std::ranges::find(ret, path) == ret.end())
+						ret.push_back(path);
+				}
+			}
+		}
+		return ret;
+	}
+#endif
+
+	const auto now = std::chrono::steady_clock::now();
+	if (now - _lastPoll < POLL_INTERVAL)
+		return ret;
+	_lastPoll = now;
+
+	for (size_t i = 0; i < _paths.size(); i++) {
+		const auto time = mtime(_paths[i]);
+		if (time != _mtimes[i]) {
+			_mtimes[i] = time;
+			ret.push_back(_paths[i]);
+		}
+	}
+	return ret;
+}
+
+} // namespace graphics::resources
@@ -2,13 +2,14 @@
 
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <unordered_map>
 
 namespace graphics::resources {
 
 std::regex Shader::type_detector("#pragma shader_stage[(]([a-zA-Z]+)[)]", std::regex_constants::ECMAScript);
 
-Shader::   Shader(std::string name) : filename(std::move(name)), type(UNKNOWN) {
+Shader::   Shader(std::string name, Defines defines) : filename(std::move(name)), macros(std::move(defines)), type(UNKNOWN) {
 	   if (!filename.empty() && !load()) {
 		   throw std::runtime_error("couldn't load file " + filename);
 	   }
@@ -29,20 +30,85 @@ bool Shader::compile() {
 		throw std::runtime_error("no content found, please load shader before trying to compile it...");
 	}
 
-	auto res = compiler.CompileGlslToSpv(*content, shaderc_glsl_infer_from_source, filename.c_str());
+	shaderc::CompileOptions options;
+	for (const auto &[name, value] : macros)
+		options.AddMacroDefinition(name, value);
+
+	auto res = compiler.CompileGlslToSpv(*content, shaderc_glsl_infer_from_source, filename.c_str(), options);
 	result	 = std::make_unique<shaderc::CompilationResult<uint32_t>>(std::move(res));
-	return result->GetCompilationStatus() == shaderc_compilation_status_success;
+	spirv.reset();
+
+	if (result->GetCompilationStatus() != shaderc_compilation_status_success)
+		return false;
+
+	spirv.emplace(result->begin(), result->end());
+	return true;
+}
+
+bool Shader::compile(const SpirvCache &cache) {
+	if (!content) {
+		throw std::runtime_error("no content found, please load shader before trying to compile it...");
+	}
+
+	const auto key = cache_key();
+	if (auto cached = cache.find(key)) {
+		result.reset();
+		spirv = std::move(*cached);
+		std::cerr << "Loaded cached SPIR-V for " << filename << std::endl;
+		return true;
+	}
+
+	if (!compile())
+		return false;
+
+	cache.store(key, *spirv);
+	return true;
+}
+
+const std::string &Shader::path() const {
+	return filename;
+}
+
+const Shader::Defines &Shader::defines() const {
+	return macros;
+}
+
+bool Shader::is_compiled() const {
+	return spirv.has_value();
+}
+
+std::future<std::shared_ptr<Shader>> Shader::compile_async(std::string name, SpirvCache cache, Defines defines) {
+	return std::async(std::launch::async, [name = std::move(name), cache = std::move(cache), defines = std::move(defines)] {
+		auto shader = std::make_shared<Shader>(name, defines);
+		shader->compile(cache);
+		return shader;
+	});
+}
+
+std::string Shader::cache_key() const {
+	unsigned int spvVersion	 = 0;
+	unsigned int spvRevision = 0;
+	shaderc_get_spv_version(&spvVersion, &spvRevision);
+
+	std::ostringstream oss;
+	oss << "shaderc " << SCOP_SHADERC_VERSION << " spv " << spvVersion << '.' << spvRevision << '|' << filename << "|infer_from_source|";
+	for (const auto &[name, value] : macros)
+		oss << "-D" << name << '=' << value << '|';
+	oss << content.value_or("");
+	return oss.str();
 }
 
 std::pair<size_t, size_t> Shader::get_num_errors() const {
-	if (!result) {
+	if (!result && !spirv) {
 		throw std::runtime_error("no compilation result found, please compile the shader before trying to access it");
 	}
+	if (!result)
+		return {0, 0};
 	return {result->GetNumErrors(), result->GetNumWarnings()};
 }
 
 std::string Shader::errors() const {
-	if (!result) {
+	if (!result && !spirv) {
 		throw std::runtime_error("no compilation result found, please compile the shader before trying to access it");
 	}
 
@@ -55,14 +121,14 @@ std::string Shader::errors() const {
 }
 
 std::vector<uint32_t> Shader::compiled() const {
-	if (!result) {
+	if (!result && !spirv) {
 		throw std::runtime_error("no compilation result found, please compile the shader before trying to access it");
 	}
-	if (result->GetCompilationStatus() != shaderc_compilation_status_success) {
+	if (!spirv) {
 		throw std::runtime_error("compiled didn't succeed, can't access SPIR-V");
 	}
 
-	return {result->begin(), result->end()};
+	return *spirv;
 }
 
 constexpr Shader::Type Shader::getType() const {
@@ -109,6 +175,7 @@ void Shader::load_file() {
 	const static std::unordered_map<std::string, Type> shader_stage_association{
 		{"fragment", FRAGMENT},
 		{"vertex",   VERTEX	 },
+		{"compute",  COMPUTE },
 	};
 
 	for (const auto &match : matches) {
@@ -1,9 +1,22 @@
 #include "graphics/swap_chain.h"
 
 #include <algorithm>
+#include <array>
+#include <utility>
 
 using graphics::SwapChainSupportDetails;
 
+namespace {
+
+constexpr std::array<std::pair<std::string_view, VkPresentModeKHR>, 4> PRESENT_MODES{{
+	{"immediate", VK_PRESENT_MODE_IMMEDIATE_KHR},
+	{"mailbox", VK_PRESENT_MODE_MAILBOX_KHR},
+	{"fifo", VK_PRESENT_MODE_FIFO_KHR},
+	{"fifo-relaxed", VK_PRESENT_MODE_FIFO_RELAXED_KHR},
+}};
+
+} // namespace
+
 SwapChainSupportDetails graphics::query_swap_chain_support(VkPhysicalDevice device, VkSurfaceKHR surface) {
 	SwapChainSupportDetails details;
 
@@ -40,7 +53,10 @@ VkSurfaceFormatKHR SwapChainSupportDetails::chooseSwapSurfaceFormat() const {
 	return formats[0];
 }
 
-VkPresentModeKHR SwapChainSupportDetails::chooseSwapPresentMode() const {
+VkPresentModeKHR SwapChainSupportDetails::chooseSwapPresentMode(const std::optional<VkPresentModeKHR> preferred) const {
+	if (preferred && std::ranges::find(presentModes, *preferred) != presentModes.end())
+		return *preferred;
+
 	for (const auto &available : presentModes) {
 		if (available == VK_PRESENT_MODE_MAILBOX_KHR)
 			return available;
@@ -66,3 +82,19 @@ VkExtent2D SwapChainSupportDetails::chooseSwapExtent(GLFWwindow *window) const {
 
 	return extent;
 }
+
+std::optional<VkPresentModeKHR> graphics::parse_present_mode(const std::string_view name) {
+	for (const auto &[modeName, mode] : PRESENT_MODES) {
+		if (modeName == name)
+			return mode;
+	}
+	return std::nullopt;
+}
+
+const char *graphics::present_mode_name(const VkPresentModeKHR mode) {
+	for (const auto &[modeName, known] : PRESENT_MODES) {
+		if (known == mode)
+			return modeName.data();
+	}
+	return "unknown";
+}
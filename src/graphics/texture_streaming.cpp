@@ -0,0 +1,250 @@
+#include "graphics/vulkan.h"
+
+#include "application.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace graphics {
+
+namespace {
+
+VkImageMemoryBarrier level_barrier(const VkImage image, const uint32_t baseLevel, const uint32_t levelCount) {
+	VkImageMemoryBarrier barrier{};
+	barrier.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	barrier.image							= image;
+	barrier.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel	= baseLevel;
+	barrier.subresourceRange.levelCount		= levelCount;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount		= 1;
+	return barrier;
+}
+
+// Offsets of BCn uploads must be a multiple of the block size
+constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+} // namespace
+
+void VulkanInstance::stream_textures(const VkPhysicalDevice &physical, const uint32_t frame_idx, const SceneView &view) {
+	auto &frame = _streamingFrames[frame_idx];
+
+	// The frame's fence was just waited on: nothing it submitted last time can still be using these
+	for (const auto &texture : frame.garbage)
+		destroy_texture_object(texture);
+	frame.garbage.clear();
+
+	update_screen_sizes(view);
+	const auto				 plan	   = _streamer.update();
+	_streamingSettled				   = plan.reallocations.empty() && plan.uploads.empty();
+	const VkCommandBuffer	&cmdBuffer = _uploadCommandBuffers[frame_idx];
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	if (vkBeginCommandBuffer(cmdBuffer, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("couldn't begin texture upload command buffer");
+	}
+	// Submitted first, so the frame's queries are reset here
+	_gpuProfiler->reset(cmdBuffer, frame_idx, _profiler.frame());
+	_gpuProfiler->begin(cmdBuffer, frame_idx, GpuProfiler::Pass::UPLOAD);
+
+	for (const auto &reallocation : plan.reallocations)
+		reallocate_texture(physical, cmdBuffer, frame_idx, reallocation);
+
+	std::vector<VkDeviceSize> offsets;
+	VkDeviceSize			  stagingSize = 0;
+	for (const auto &[texture, level] : plan.uploads) {
+		offsets.push_back(stagingSize);
+		stagingSize += (_textures[texture].source.level_size(level) + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+	}
+	reserve_staging(physical, frame_idx, stagingSize);
+
+	for (size_t i = 0; i < plan.uploads.size(); i++)
+		upload_texture_level(cmdBuffer, frame_idx, plan.uploads[i], offsets[i]);
+
+	_gpuProfiler->end(cmdBuffer, frame_idx, GpuProfiler::Pass::UPLOAD);
+	if (vkEndCommandBuffer(cmdBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("couldn't record texture upload command buffer");
+	}
+
+	// Only this frame's sets: the others may still be read by frames in flight, they catch up when recorded next
+	for (uint32_t texture = 0; texture < _textures.size(); texture++) {
+		const size_t   index  = frame_idx * _textures.size() + texture;
+		const uint32_t minLod = _streamer.resident(texture) - _streamer.base(texture);
+		if (_boundImages[index] != std::pair{_textures[texture].view, minLod})
+			write_texture_descriptor(frame_idx, texture);
+	}
+}
+
+void VulkanInstance::update_screen_sizes(const SceneView &view) {
+	// Projected size of each texture's bounding sphere, a texture filling `n` pixels across is sharp with a level `n` texels wide
+	const float focalX = view.proj[0][0];
+	const float focalY = std::abs(view.proj[1][1]);
+	const auto	modelView = view.model * view.view;
+	const auto	height = static_cast<float>(_swapchainExtent.height);
+
+	for (uint32_t texture = 0; texture < _textures.size(); texture++) {
+		const auto &[center, radius] = _textureBounds[texture];
+		if (radius < 0.0f) {
+			_streamer.set_screen_size(texture, 0.0f);
+			continue;
+		}
+
+		const auto	viewCenter = modelView.transform_point(center);
+		// The camera looks down -z
+		const float depth	   = -viewCenter.z();
+
+		if (depth <= radius) {
+			// Close enough for the camera to be inside the sphere
+			_streamer.set_screen_size(texture, depth + radius > 0.0f ? height : 0.0f);
+			continue;
+		}
+
+		const float x		= std::abs(viewCenter.x()) * focalX / depth;
+		const float y		= std::abs(viewCenter.y()) * focalY / depth;
+		const bool	visible = x - radius * focalX / depth <= 1.0f && y - radius * focalY / depth <= 1.0f;
+		_streamer.set_screen_size(texture, visible ? radius * focalY / depth * height : 0.0f);
+	}
+}
+
+void VulkanInstance::reserve_staging(const VkPhysicalDevice &physical, const uint32_t frame_idx, const VkDeviceSize size) {
+	auto &frame = _streamingFrames[frame_idx];
+	if (size <= frame.stagingCapacity)
+		return;
+
+	vkDestroyBuffer(_device, frame.staging, nullptr);
+	vkFreeMemory(_device, frame.stagingMemory, nullptr);
+
+	constexpr VkBufferUsageFlags	usage					 = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	constexpr VkMemoryPropertyFlags properties				 = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	std::tie(frame.staging, frame.stagingMemory)			 = create_buffer(physical, size, usage, properties);
+	frame.stagingCapacity									 = size;
+	vkMapMemory(_device, frame.stagingMemory, 0, size, 0, &frame.stagingMapped);
+}
+
+void VulkanInstance::reallocate_texture(const VkPhysicalDevice &physical, const VkCommandBuffer cmdBuffer, const uint32_t frame_idx,
+										const assets::TextureStreamer::Reallocation &reallocation) {
+	const auto &[texture, previousBase, base, keptFrom] = reallocation;
+	auto						   &old				   = _textures[texture];
+	const auto					   &source			   = old.source;
+
+	TextureObject					obj{};
+	obj.format							= old.format;
+	obj.mipLevels						= source.levels - base;
+	obj.source							= source;
+
+	constexpr VkImageUsageFlags		usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	constexpr VkMemoryPropertyFlags props = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	std::tie(obj.img, obj.memory)		  = create_image(physical, source.level_width(base), source.level_height(base), obj.mipLevels, VK_SAMPLE_COUNT_1_BIT,
+														 obj.format, VK_IMAGE_TILING_OPTIMAL, usage, props);
+
+	const auto view						  = create_image_view(obj.img, obj.format, VK_IMAGE_ASPECT_COLOR_BIT, obj.mipLevels);
+	if (!view) {
+		throw std::runtime_error("couldn't create image view for streamed texture " + std::to_string(texture));
+	}
+	obj.view = *view;
+
+	// The kept levels move over GPU side; reads of the old image by earlier frames complete before they're copied
+	std::array<VkImageMemoryBarrier, 2> barriers{
+		level_barrier(old.img, keptFrom - previousBase, source.levels - keptFrom),
+		level_barrier(obj.img, 0, obj.mipLevels),
+	};
+	barriers[0].oldLayout	  = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barriers[0].newLayout	  = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barriers[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	barriers[1].oldLayout	  = VK_IMAGE_LAYOUT_UNDEFINED;
+	barriers[1].newLayout	  = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barriers[1].srcAccessMask = 0;
+	barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+	// clang-format off
+	vkCmdPipelineBarrier(cmdBuffer,
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr,
+		0, nullptr,
+		barriers.size(), barriers.data());
+	// clang-format on
+
+	std::vector<VkImageCopy> regions;
+	for (uint32_t level = keptFrom; level < source.levels; level++) {
+		VkImageCopy region{};
+		region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - previousBase, 0, 1};
+		region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - base, 0, 1};
+		region.extent		  = {static_cast<uint32_t>(source.level_width(level)), static_cast<uint32_t>(source.level_height(level)), 1};
+		regions.push_back(region);
+	}
+	vkCmdCopyImage(cmdBuffer, old.img, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, obj.img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions.size(), regions.data());
+
+	// Levels not uploaded yet are left undefined, the sampler's minLod keeps them from being read
+	auto barrier		  = level_barrier(obj.img, 0, obj.mipLevels);
+	barrier.oldLayout	  = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout	  = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	// clang-format off
+	vkCmdPipelineBarrier(cmdBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+		0, nullptr,
+		0, nullptr,
+		1, &barrier);
+	// clang-format on
+
+	// Frames in flight may still sample the old image through their own descriptor sets
+	_streamingFrames[frame_idx].garbage.push_back(old);
+	old = std::move(obj);
+}
+
+void VulkanInstance::upload_texture_level(const VkCommandBuffer cmdBuffer, const uint32_t frame_idx, const assets::TextureStreamer::Upload &upload,
+										  const VkDeviceSize offset) const {
+	const auto &[texture, level] = upload;
+	const auto &obj				 = _textures[texture];
+	const auto &source			 = obj.source;
+	const auto	imageLevel		 = level - _streamer.base(texture);
+	const auto &frame			 = _streamingFrames[frame_idx];
+
+	memcpy(static_cast<uint8_t *>(frame.stagingMapped) + offset, source.pixels.get() + source.level_offset(level), source.level_size(level));
+
+	// Levels below the resident one are never sampled, whatever they held before is discarded
+	auto barrier		  = level_barrier(obj.img, imageLevel, 1);
+	barrier.oldLayout	  = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout	  = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+	// clang-format off
+	vkCmdPipelineBarrier(cmdBuffer,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr,
+		0, nullptr,
+		1, &barrier);
+	// clang-format on
+
+	VkBufferImageCopy region{};
+	region.bufferOffset		= offset;
+	region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, imageLevel, 0, 1};
+	region.imageOffset		= {0, 0, 0};
+	region.imageExtent		= {static_cast<uint32_t>(source.level_width(level)), static_cast<uint32_t>(source.level_height(level)), 1};
+	vkCmdCopyBufferToImage(cmdBuffer, frame.staging, obj.img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+	barrier.oldLayout	  = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout	  = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	// clang-format off
+	vkCmdPipelineBarrier(cmdBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+		0, nullptr,
+		0, nullptr,
+		1, &barrier);
+	// clang-format on
+}
+
+} // namespace graphics
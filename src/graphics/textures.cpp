@@ -2,6 +2,10 @@
 
 #include "stb_image.h"
 
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
 namespace graphics::resources {
 
 Texture Texture::load(const std::string &path) {
@@ -17,19 +21,74 @@ Texture Texture::load(const std::string &path) {
 
 	return {
 		.pixels	  = std::shared_ptr<uint8_t>(img, stbi_image_free),
-		.channels = 4UL,
 		.w		  = static_cast<size_t>(w),
 		.h		  = static_cast<size_t>(h),
+		.channels = 4UL,
+		.levels	  = 1,
+		.format	  = Format::RGBA8_SRGB,
 	};
 }
 
-VkDeviceSize Texture::device_size() const {
-	return w * h * channels;
+Texture Texture::solid(const uint8_t r, const uint8_t g, const uint8_t b, const uint8_t a) {
+	std::shared_ptr<uint8_t> pixels(new uint8_t[4]{r, g, b, a}, std::default_delete<uint8_t[]>());
+
+	return {
+		.pixels	  = std::move(pixels),
+		.w		  = 1UL,
+		.h		  = 1UL,
+		.channels = 4UL,
+		.levels	  = 1,
+		.format	  = Format::RGBA8_SRGB,
+	};
 }
 
-Texture::operator bool() const {
-	return pixels && w && h && channels;
+uint32_t Texture::mip_count(const size_t w, const size_t h) {
+	return static_cast<uint32_t>(std::bit_width(std::max<size_t>({w, h, 1})));
+}
+
+size_t Texture::level_width(const uint32_t level) const {
+	return std::max<size_t>(w >> level, 1);
 }
 
+size_t Texture::level_height(const uint32_t level) const {
+	return std::max<size_t>(h >> level, 1);
+}
+
+size_t Texture::level_offset(const uint32_t level) const {
+	size_t offset = 0;
+	for (uint32_t i = 0; i < level; i++)
+		offset += level_size(i);
+	return offset;
+}
+
+size_t Texture::level_size(const uint32_t level) const {
+	if (compressed())
+		return ((level_width(level) + 3) / 4) * ((level_height(level) + 3) / 4) * block_bytes(format);
+	return level_width(level) * level_height(level) * channels;
+}
+
+bool Texture::compressed() const {
+	return format != Format::RGBA8_SRGB;
+}
+
+size_t Texture::block_bytes(const Format format) {
+	switch (format) {
+	case Format::RGBA8_SRGB:
+		return 4;
+	case Format::BC1_RGBA_SRGB:
+		return 8;
+	case Format::BC7_SRGB:
+		return 16;
+	}
+	throw std::invalid_argument("unknown texture format");
+}
+
+size_t Texture::device_size() const {
+	return level_offset(levels);
+}
+
+Texture::operator bool() const {
+	return pixels && w && h && channels && levels;
+}
 
 } // namespace graphics::resources
@@ -17,11 +17,14 @@ const std::vector<const char *> DEVICE_EXTENSIONS = {
 #endif
 };
 
-std::vector<const char *> get_required_extensions() {
-	uint32_t				  glfwExtensionCount = 0;
-	const char				**glfwExtensions	 = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+std::vector<const char *> get_required_extensions(const bool headless) {
+	std::vector<const char *> extensions;
 
-	std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	if (!headless) {
+		uint32_t	 glfwExtensionCount = 0;
+		const char **glfwExtensions		= glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+		extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	}
 
 	if constexpr (ENABLE_VALIDATION_LAYERS) // NOLINT: Simplify
 		extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -35,6 +38,16 @@ std::vector<const char *> get_required_extensions() {
 }
 
 
+std::vector<const char *> get_device_extensions(const bool headless) {
+	std::vector<const char *> extensions;
+	for (const auto &extension : DEVICE_EXTENSIONS) {
+		if (!headless || std::strcmp(extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME) != 0)
+			extensions.push_back(extension);
+	}
+	return extensions;
+}
+
+
 bool check_validation_layer_support() {
 	uint32_t layerCount;
 	vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
@@ -58,25 +71,28 @@ bool check_validation_layer_support() {
 }
 
 
-bool check_device_extension_support(const VkPhysicalDevice physicalDevice) {
+bool check_device_extension_support(const VkPhysicalDevice physicalDevice, const bool headless) {
 	uint32_t extensionCount;
 	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
 
 	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
 	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, availableExtensions.data());
 
-	std::set<std::string> requiredExtensions(DEVICE_EXTENSIONS.begin(), DEVICE_EXTENSIONS.end());
+	const auto			  required = get_device_extensions(headless);
+	std::set<std::string> requiredExtensions(required.begin(), required.end());
 	for (const auto &extension : availableExtensions)
 		requiredExtensions.erase(extension.extensionName);
 
 	return requiredExtensions.empty();
 }
 
-VkSampleCountFlagBits get_max_usable_sample_count(const VkPhysicalDevice &physical) {
+VkSampleCountFlagBits get_max_usable_sample_count(const VkPhysicalDevice &physical, const bool sampledDepth) {
 	VkPhysicalDeviceProperties props;
 	vkGetPhysicalDeviceProperties(physical, &props);
 
-	const VkSampleCountFlags counts = props.limits.framebufferColorSampleCounts & props.limits.framebufferDepthSampleCounts;
+	VkSampleCountFlags counts = props.limits.framebufferColorSampleCounts & props.limits.framebufferDepthSampleCounts;
+	if (sampledDepth)
+		counts &= props.limits.sampledImageDepthSampleCounts;
 	if (counts & VK_SAMPLE_COUNT_64_BIT)
 		return VK_SAMPLE_COUNT_64_BIT;
 	if (counts & VK_SAMPLE_COUNT_32_BIT)
@@ -93,32 +109,44 @@ VkSampleCountFlagBits get_max_usable_sample_count(const VkPhysicalDevice &physic
 	return VK_SAMPLE_COUNT_1_BIT;
 }
 
-VkVertexInputBindingDescription VertexData::getBindingDesc() {
-	VkVertexInputBindingDescription res{};
-	res.binding	  = 0;
-	res.stride	  = sizeof(VertexData);
-	res.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+std::array<VkVertexInputBindingDescription, 2> VertexData::getBindingDescs() {
+	std::array<VkVertexInputBindingDescription, 2> res{};
+	res[0].binding	 = 0;
+	res[0].stride	 = sizeof(geometry::Vertex);
+	res[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+	res[1].binding	 = 1;
+	res[1].stride	 = sizeof(maths::Mat4);
+	res[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
 
 	return res;
 }
 
-std::array<VkVertexInputAttributeDescription, 3> VertexData::getAttributeDescs() {
-	std::array<VkVertexInputAttributeDescription, 3> attrs{};
+std::array<VkVertexInputAttributeDescription, 7> VertexData::getAttributeDescs() {
+	std::array<VkVertexInputAttributeDescription, 7> attrs{};
 
 	attrs[0].binding  = 0;
 	attrs[0].location = 0;
 	attrs[0].format	  = VK_FORMAT_R32G32B32_SFLOAT;
-	attrs[0].offset	  = offsetof(VertexData, position);
+	attrs[0].offset	  = offsetof(geometry::Vertex, position);
 
 	attrs[1].binding  = 0;
 	attrs[1].location = 1;
 	attrs[1].format	  = VK_FORMAT_R32G32B32_SFLOAT;
-	attrs[1].offset	  = offsetof(VertexData, color);
+	attrs[1].offset	  = offsetof(geometry::Vertex, color);
 
 	attrs[2].binding  = 0;
 	attrs[2].location = 2;
 	attrs[2].format	  = VK_FORMAT_R32G32_SFLOAT;
-	attrs[2].offset	  = offsetof(VertexData, tex);
+	attrs[2].offset	  = offsetof(geometry::Vertex, tex);
+
+	// A mat4 input takes a location per column, Mat4 storing them one after the other
+	for (uint32_t column = 0; column < 4; column++) {
+		attrs[3 + column].binding  = 1;
+		attrs[3 + column].location = 3 + column;
+		attrs[3 + column].format   = VK_FORMAT_R32G32B32A32_SFLOAT;
+		attrs[3 + column].offset   = column * 4 * sizeof(float);
+	}
 
 	return attrs;
 }
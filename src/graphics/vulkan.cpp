@@ -1,28 +1,46 @@
 #include "graphics/vulkan.h"
 
 #include "application.h"
+#include "assets/mipmaps.h"
 #include "graphics/debug.h"
 #include "graphics/queue_families.h"
 #include "graphics/swap_chain.h"
 #include "graphics/utils.h"
-#include "parser/parser.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
-#include <unordered_map>
 
 namespace graphics {
 
-VulkanInstance::VulkanInstance() {
-	init_geometry();
+namespace {
+
+VkFormat vk_format(const resources::Texture::Format format) {
+	switch (format) {
+	case resources::Texture::Format::RGBA8_SRGB:
+		return VK_FORMAT_R8G8B8A8_SRGB;
+	case resources::Texture::Format::BC1_RGBA_SRGB:
+		return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+	case resources::Texture::Format::BC7_SRGB:
+		return VK_FORMAT_BC7_SRGB_BLOCK;
+	}
+	throw std::invalid_argument("unknown texture format");
+}
+
+} // namespace
+
+VulkanInstance::VulkanInstance(const std::optional<VkExtent2D> offscreen) : _offscreen(offscreen) {
 	create_instance();
 	create_debug_messenger();
 }
 
 
 VulkanInstance::~VulkanInstance() {
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+	for (size_t i = 0; i < _framesInFlight; i++) {
 		if (i < _inFlightFences.size())
 			vkDestroyFence(_device, _inFlightFences[i], nullptr);
 		if (i < _renderFinishedSemaphores.size())
@@ -33,14 +51,23 @@ VulkanInstance::~VulkanInstance() {
 
 	vkDestroyCommandPool(_device, _shortLivedCommandPool, nullptr);
 	vkDestroyCommandPool(_device, _commandPool, nullptr);
+	for (const auto &pool : _secondaryCommandPools)
+		vkDestroyCommandPool(_device, pool, nullptr);
 
 	cleanup_swapchain();
 
-	vkDestroySampler(_device, _sampler, nullptr);
+	for (const auto &sampler : _samplers)
+		vkDestroySampler(_device, sampler, nullptr);
+
+	for (const auto &texture : _textures)
+		destroy_texture_object(texture);
 
-	vkDestroyImageView(_device, _texImgView, nullptr);
-	vkDestroyImage(_device, _texImg, nullptr);
-	vkFreeMemory(_device, _texImgMemory, nullptr);
+	for (const auto &frame : _streamingFrames) {
+		for (const auto &texture : frame.garbage)
+			destroy_texture_object(texture);
+		vkDestroyBuffer(_device, frame.staging, nullptr);
+		vkFreeMemory(_device, frame.stagingMemory, nullptr);
+	}
 
 	vkDestroyBuffer(_device, _vertexBuffer, nullptr);
 	vkFreeMemory(_device, _vertexBufferMemory, nullptr);
@@ -48,14 +75,27 @@ VulkanInstance::~VulkanInstance() {
 	vkDestroyBuffer(_device, _indexBuffer, nullptr);
 	vkFreeMemory(_device, _indexBufferMemory, nullptr);
 
-	for (size_t i = 0; i < _uniformBuffers.size(); i++) {
-		vkDestroyBuffer(_device, _uniformBuffers[i], nullptr);
-		vkFreeMemory(_device, _uniformBuffersMemory[i], nullptr);
+	vkDestroyBuffer(_device, _instanceBuffer, nullptr);
+	vkFreeMemory(_device, _instanceBufferMemory, nullptr);
+
+	for (const auto &[buffer, memory] : {_cullBuffers.objects, _cullBuffers.objectDraws, _cullBuffers.instanceObjects, _cullBuffers.initialDraws,
+										 _cullBuffers.view, _cullBuffers.draws, _cullBuffers.visible, _cullBuffers.visibility}) {
+		vkDestroyBuffer(_device, buffer, nullptr);
+		vkFreeMemory(_device, memory, nullptr);
 	}
-	_uniformBuffersMapped.clear();
+
+	vkDestroyBuffer(_device, _uniformRing, nullptr);
+	vkFreeMemory(_device, _uniformRingMemory, nullptr);
+
+	vkDestroySampler(_device, _pyramidSampler, nullptr);
 
 	vkDestroyDescriptorPool(_device, _descriptorPool, nullptr);
+	destroy_retired_pipelines(true);
 	_pipeline.reset();
+	_cullPipeline.reset();
+	_pyramidPipeline.reset();
+	_pipelineCache.reset();
+	_gpuProfiler.reset();
 	vkDestroyDevice(_device, nullptr);
 
 	if constexpr (ENABLE_VALIDATION_LAYERS) // NOLINT: Simplify
@@ -88,7 +128,7 @@ void VulkanInstance::create_instance() {
 	createInfo.sType				   = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
 	createInfo.pApplicationInfo		   = &appInfo;
 
-	const auto extensions			   = get_required_extensions();
+	const auto extensions			   = get_required_extensions(headless());
 	createInfo.enabledExtensionCount   = static_cast<uint32_t>(extensions.size());
 	createInfo.ppEnabledExtensionNames = extensions.data();
 
@@ -158,17 +198,33 @@ void VulkanInstance::create_device(VkPhysicalDevice device) {
 		queueCreateInfos.push_back(queueCreateInfo);
 	}
 
+	VkPhysicalDeviceFeatures supportedFeatures;
+	vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
+
 	VkPhysicalDeviceFeatures deviceFeatures{};
-	deviceFeatures.samplerAnisotropy = VK_TRUE;
-	deviceFeatures.sampleRateShading = VK_TRUE;
+	deviceFeatures.samplerAnisotropy	= VK_TRUE;
+	deviceFeatures.sampleRateShading	= VK_TRUE;
+	deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+	// Optional: without it BCn textures are rejected by supports_texture_format and decoded to RGBA8 instead
+	deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+	// Optional: without it GPU-driven draws are issued one indirect command at a time
+	deviceFeatures.multiDrawIndirect	= supportedFeatures.multiDrawIndirect;
+	// GPU-driven only, checked by create_cull_pipeline: indirect commands start at their batch's room in the visible instances
+	deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+	_drawIndirectFirstInstance				 = supportedFeatures.drawIndirectFirstInstance;
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device, &properties);
+	_maxDrawIndirectCount = supportedFeatures.multiDrawIndirect ? std::max(1u, properties.limits.maxDrawIndirectCount) : 1;
 
 	VkDeviceCreateInfo createInfo{};
 	createInfo.sType				   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 	createInfo.pQueueCreateInfos	   = queueCreateInfos.data();
 	createInfo.queueCreateInfoCount	   = static_cast<uint32_t>(queueCreateInfos.size());
 	createInfo.pEnabledFeatures		   = &deviceFeatures;
-	createInfo.enabledExtensionCount   = static_cast<uint32_t>(DEVICE_EXTENSIONS.size());
-	createInfo.ppEnabledExtensionNames = DEVICE_EXTENSIONS.data();
+	const auto extensions			   = get_device_extensions(headless());
+	createInfo.enabledExtensionCount   = static_cast<uint32_t>(extensions.size());
+	createInfo.ppEnabledExtensionNames = extensions.data();
 	createInfo.enabledLayerCount	   = 0;
 
 	if (ENABLE_VALIDATION_LAYERS) { // NOLINT: Simplify
@@ -182,18 +238,29 @@ void VulkanInstance::create_device(VkPhysicalDevice device) {
 	_renderer->acquire_queues(indices);
 
 	std::cerr << "Created successfully a logical device and acquired graphics and present queues" << std::endl;
+
+	_pipelineCache = std::make_unique<PipelineCache>(_device, device);
 }
 
 void VulkanInstance::create_swapchain(const VkPhysicalDevice physical) {
+	if (headless()) {
+		create_offscreen_images(physical);
+		return;
+	}
+
 	const SwapChainSupportDetails swapChainSupport = query_swap_chain_support(physical, get_surface());
 
-	const VkPresentModeKHR		  presentMode	   = swapChainSupport.chooseSwapPresentMode();
+	const VkPresentModeKHR		  presentMode	   = swapChainSupport.chooseSwapPresentMode(_presentMode);
 	const auto [formatKHR, colorSpace]			   = swapChainSupport.chooseSwapSurfaceFormat();
 	const VkExtent2D extent						   = swapChainSupport.chooseSwapExtent(_renderer->_window);
+	if (_presentMode && presentMode != *_presentMode)
+		std::cerr << "warning: " << present_mode_name(*_presentMode) << " present mode unsupported, using " << present_mode_name(presentMode) << std::endl;
 
-	uint32_t		 imageCount					   = swapChainSupport.capabilities.minImageCount + 1;
-	if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount)
-		imageCount = swapChainSupport.capabilities.maxImageCount;
+	// A maximum of 0 meaning none
+	const VkSurfaceCapabilitiesKHR &capabilities = swapChainSupport.capabilities;
+	uint32_t						imageCount	 = std::max(capabilities.minImageCount, _swapchainImageCount.value_or(capabilities.minImageCount + 1));
+	if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount)
+		imageCount = capabilities.maxImageCount;
 
 	VkSwapchainCreateInfoKHR createInfo{};
 	createInfo.sType									 = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -206,7 +273,7 @@ void VulkanInstance::create_swapchain(const VkPhysicalDevice physical) {
 	createInfo.imageArrayLayers							 = 1;
 	createInfo.imageUsage								 = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
-	const auto [graphicsQueueFamily, presentQueueFamily] = find_queue_families(physical, get_surface());
+	const auto [graphicsQueueFamily, presentQueueFamily, computeQueueFamily] = find_queue_families(physical, get_surface());
 	const std::array indices_arr{graphicsQueueFamily.value(), presentQueueFamily.value()};
 
 	if (graphicsQueueFamily != presentQueueFamily) {
@@ -237,7 +304,7 @@ void VulkanInstance::create_swapchain(const VkPhysicalDevice physical) {
 	_swapchainFormat = formatKHR;
 	_swapchainExtent = extent;
 
-	std::cerr << "Successfully created swapchain and retrieved associated images" << std::endl;
+	std::cerr << "Successfully created swapchain and retrieved its " << imageCount << " images" << std::endl;
 }
 
 void VulkanInstance::cleanup_swapchain() {
@@ -249,6 +316,13 @@ void VulkanInstance::cleanup_swapchain() {
 	vkDestroyImage(_device, _depthImg, nullptr);
 	vkFreeMemory(_device, _depthImgMemory, nullptr);
 
+	for (const auto &view : _depthPyramid.levelViews)
+		vkDestroyImageView(_device, view, nullptr);
+	_depthPyramid.levelViews.clear();
+	vkDestroyImageView(_device, _depthPyramid.view, nullptr);
+	vkDestroyImage(_device, _depthPyramid.img, nullptr);
+	vkFreeMemory(_device, _depthPyramid.memory, nullptr);
+
 	for (const auto &framebuffer : _framebuffers) {
 		vkDestroyFramebuffer(_device, framebuffer, nullptr);
 	}
@@ -261,8 +335,90 @@ void VulkanInstance::cleanup_swapchain() {
 	_swapchainImageViews.clear();
 
 	vkDestroySwapchainKHR(_device, _swapchain, nullptr);
-	_swapchainImages.clear();
 	_swapchain = VK_NULL_HANDLE;
+
+	if (headless()) {
+		for (size_t i = 0; i < _swapchainImages.size(); i++) {
+			vkDestroyImage(_device, _swapchainImages[i], nullptr);
+			vkFreeMemory(_device, _offscreenMemory[i], nullptr);
+		}
+		_offscreenMemory.clear();
+	}
+	_swapchainImages.clear();
+}
+
+void VulkanInstance::create_offscreen_images(const VkPhysicalDevice &physical) {
+	// One per frame in flight, RGBA so that they can be written out as is
+	_swapchainFormat = VK_FORMAT_R8G8B8A8_SRGB;
+	_swapchainExtent = *_offscreen;
+
+	for (size_t i = 0; i < _framesInFlight; i++) {
+		const auto [image, memory] =
+			create_image(physical, _swapchainExtent.width, _swapchainExtent.height, 1, VK_SAMPLE_COUNT_1_BIT, _swapchainFormat, VK_IMAGE_TILING_OPTIMAL,
+						 VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		_swapchainImages.push_back(image);
+		_offscreenMemory.push_back(memory);
+	}
+
+	std::cerr << "Successfully created " << _swapchainImages.size() << " offscreen images of " << _swapchainExtent.width << "x"
+			  << _swapchainExtent.height << std::endl;
+}
+
+std::vector<uint8_t> VulkanInstance::read_back(const VkPhysicalDevice &physical, const uint32_t frame_idx) const {
+	waitIdle();
+
+	const VkDeviceSize size = VkDeviceSize{_swapchainExtent.width} * _swapchainExtent.height * 4;
+	const auto [buffer, memory] =
+		create_buffer(physical, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	const VkCommandBuffer cmdBuffer = begin_single_time_command();
+
+	// The render pass left the image ready to be copied, its writes still have to be made visible to the copy
+	VkImageMemoryBarrier  barrier{};
+	barrier.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout						= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barrier.newLayout						= VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+	barrier.image							= _swapchainImages[frame_idx];
+	barrier.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel	= 0;
+	barrier.subresourceRange.levelCount		= 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount		= 1;
+	barrier.srcAccessMask					= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	barrier.dstAccessMask					= VK_ACCESS_TRANSFER_READ_BIT;
+	vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+						 &barrier);
+
+	VkBufferImageCopy region{};
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent				   = {_swapchainExtent.width, _swapchainExtent.height, 1};
+	vkCmdCopyImageToBuffer(cmdBuffer, _swapchainImages[frame_idx], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &region);
+
+	VkBufferMemoryBarrier hostBarrier{};
+	hostBarrier.sType				= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	hostBarrier.srcAccessMask		= VK_ACCESS_TRANSFER_WRITE_BIT;
+	hostBarrier.dstAccessMask		= VK_ACCESS_HOST_READ_BIT;
+	hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	hostBarrier.buffer				= buffer;
+	hostBarrier.offset				= 0;
+	hostBarrier.size				= VK_WHOLE_SIZE;
+	vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+
+	end_single_time_command(cmdBuffer);
+
+	std::vector<uint8_t> pixels(size);
+	void				*mapped;
+	vkMapMemory(_device, memory, 0, size, 0, &mapped);
+	std::memcpy(pixels.data(), mapped, pixels.size());
+	vkUnmapMemory(_device, memory);
+
+	vkDestroyBuffer(_device, buffer, nullptr);
+	vkFreeMemory(_device, memory, nullptr);
+	return pixels;
 }
 
 
@@ -284,6 +440,9 @@ void VulkanInstance::recreate_swapchain(const VkPhysicalDevice physical) {
 	create_color_resources(physical);
 	create_depth_img(physical);
 	create_framebuffers();
+	if (_occlusionCulling)
+		write_pyramid_descriptors();
+	invalidate_command_buffers();
 }
 
 
@@ -302,19 +461,59 @@ void VulkanInstance::create_image_views() {
 	}
 }
 
-void VulkanInstance::create_pipeline(const VkPhysicalDevice &physical, std::string vertex_shader, std::string fragment_shader) {
-	_pipeline = std::make_unique<Pipeline>(_device, std::move(vertex_shader), std::move(fragment_shader), _msaaSamples);
+void VulkanInstance::create_pipeline(const VkPhysicalDevice &physical, std::shared_ptr<resources::Shader> vertex,
+									 std::shared_ptr<resources::Shader> fragment) {
+	_textureSlots = std::clamp(static_cast<uint32_t>(_textures.size()), 1u, max_texture_slots(physical));
+	std::cerr << "Binding " << _textures.size() << " textures in sets of " << _textureSlots << std::endl;
 
-	if (!_pipeline->compile_shaders()) {
+	_pipeline = std::make_unique<Pipeline>(_device, std::move(vertex), std::move(fragment), _msaaSamples, _textureSlots);
+
+	if (!_pipeline->shaders_compiled()) {
 		const auto &[errors, warnings] = _pipeline->get_num_errors();
 		std::cerr << "got " << errors << " errors and " << warnings << " warnings\n" << _pipeline->errors() << std::endl;
 		throw std::runtime_error("couldn't compile shaders");
 	}
 	_pipeline->setup_shader_modules();
 
-	_pipeline->setup_render_pass(_swapchainFormat, find_depth_format(physical));
+	_pipeline->setup_render_pass(_swapchainFormat, find_depth_format(physical, _occlusionCulling),
+								 headless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, _occlusionCulling);
 	_pipeline->create_descriptor_set_layout();
-	_pipeline->setup(_swapchainExtent);
+	_pipeline->setup(static_cast<VkPipelineCache>(*_pipelineCache));
+}
+
+void VulkanInstance::create_cull_pipeline(const VkPhysicalDevice &physical, std::shared_ptr<resources::Shader> shader) {
+	const auto indices = find_queue_families(physical, get_surface());
+	if (!indices.computeFamily || indices.computeFamily != indices.graphicsFamily)
+		throw std::runtime_error("GPU-driven rendering needs a queue family with both graphics and compute");
+	if (!_drawIndirectFirstInstance)
+		throw std::runtime_error("GPU-driven rendering needs the drawIndirectFirstInstance device feature, run without --gpu-driven");
+
+	_cullPipeline = std::make_unique<ComputePipeline>(_device, std::move(shader));
+	_cullPipeline->setup(static_cast<VkPipelineCache>(*_pipelineCache));
+}
+
+bool VulkanInstance::gpu_driven() const {
+	return _cullPipeline != nullptr;
+}
+
+void VulkanInstance::create_pyramid_pipeline(std::shared_ptr<resources::Shader> shader) {
+	_pyramidPipeline = std::make_unique<ComputePipeline>(_device, std::move(shader));
+	_pyramidPipeline->setup(static_cast<VkPipelineCache>(*_pipelineCache));
+
+	// Texels are fetched one by one, never filtered
+	VkSamplerCreateInfo createInfo{};
+	createInfo.sType		= VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	createInfo.magFilter	= VK_FILTER_NEAREST;
+	createInfo.minFilter	= VK_FILTER_NEAREST;
+	createInfo.mipmapMode	= VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	createInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	createInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	createInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	createInfo.maxLod		= VK_LOD_CLAMP_NONE;
+	if (vkCreateSampler(_device, &createInfo, nullptr, &_pyramidSampler) != VK_SUCCESS) {
+		throw std::runtime_error("couldn't create depth pyramid sampler");
+	}
+	std::cerr << "Created successfully depth pyramid sampler" << std::endl;
 }
 
 void VulkanInstance::create_framebuffers() {
@@ -346,7 +545,7 @@ void VulkanInstance::create_framebuffers() {
 }
 
 void VulkanInstance::create_command_pool(const VkPhysicalDevice &physical) {
-	const auto [graphicsQueueFamily, presentQueueFamily] = find_queue_families(physical, get_surface());
+	const auto [graphicsQueueFamily, presentQueueFamily, computeQueueFamily] = find_queue_families(physical, get_surface());
 
 	VkCommandPoolCreateInfo createInfo{};
 	createInfo.sType			= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -357,10 +556,24 @@ void VulkanInstance::create_command_pool(const VkPhysicalDevice &physical) {
 		throw std::runtime_error("couldn't create command pool for current device");
 	}
 	std::cerr << "Created successfully command pool for current device" << std::endl;
+
+	// The render thread records alongside the workers
+	_recordThreads = std::max(1u, std::thread::hardware_concurrency());
+	_recordPool	   = std::make_unique<assets::ThreadPool>(_recordThreads - 1);
+
+	// Reset as a whole every frame rather than buffer by buffer
+	createInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	_secondaryCommandPools.resize(_framesInFlight * _recordThreads);
+	for (auto &pool : _secondaryCommandPools) {
+		if (vkCreateCommandPool(_device, &createInfo, nullptr, &pool) != VK_SUCCESS) {
+			throw std::runtime_error("couldn't create recording thread command pool for current device");
+		}
+	}
+	std::cerr << "Created successfully command pools for " << _recordThreads << " recording threads" << std::endl;
 }
 
 void VulkanInstance::create_short_lived_command_pool(const VkPhysicalDevice &physical) {
-	const auto [graphicsQueueFamily, presentQueueFamily] = find_queue_families(physical, get_surface());
+	const auto [graphicsQueueFamily, presentQueueFamily, computeQueueFamily] = find_queue_families(physical, get_surface());
 
 	VkCommandPoolCreateInfo createInfo{};
 	createInfo.sType			= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -377,21 +590,35 @@ void VulkanInstance::create_uniform_buffers(const VkPhysicalDevice &physical) {
 	constexpr VkBufferUsageFlags	usage	   = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 	constexpr VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-	_uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-	_uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-	_uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+	VkPhysicalDeviceProperties		props;
+	vkGetPhysicalDeviceProperties(physical, &props);
+
+	// Every offset bound, frame or object, is a multiple of the stride
+	const VkDeviceSize alignment  = props.limits.minUniformBufferOffsetAlignment;
+	const auto		   align	  = [alignment](const VkDeviceSize size) { return (size + alignment - 1) / alignment * alignment; };
+	_uniformStride				  = align(std::max(sizeof(FrameUniforms), sizeof(ObjectUniforms)));
+	_uniformRegionSize			  = _uniformStride * (1 + _objects.size());
+	const VkDeviceSize bufferSize = _uniformRegionSize * _framesInFlight;
+
+	std::tie(_uniformRing, _uniformRingMemory) = create_buffer(physical, bufferSize, usage, properties);
+	void *mapped;
+	vkMapMemory(_device, _uniformRingMemory, 0, bufferSize, 0, &mapped);
+	_uniformRingMapped = static_cast<uint8_t *>(mapped);
+	std::cerr << "Created successfully uniform buffer of " << bufferSize << " bytes for " << _objects.size() << " objects" << std::endl;
+}
 
-	for (size_t i = 0; i < _uniformBuffers.size(); i++) {
-		constexpr VkDeviceSize bufferSize					   = sizeof(UniformBufferObject);
+VkDeviceSize VulkanInstance::frame_uniforms_offset(const uint32_t frame) const {
+	return frame * _uniformRegionSize;
+}
 
-		std::tie(_uniformBuffers[i], _uniformBuffersMemory[i]) = create_buffer(physical, bufferSize, usage, properties);
-		vkMapMemory(_device, _uniformBuffersMemory[i], 0, bufferSize, 0, &_uniformBuffersMapped[i]);
-		std::cerr << "Created successfully uniform buffer " << i << std::endl;
-	}
+VkDeviceSize VulkanInstance::object_uniforms_offset(const uint32_t frame, const uint32_t object) const {
+	return frame_uniforms_offset(frame) + (1 + object) * _uniformStride;
 }
 
 void VulkanInstance::create_command_buffers() {
-	_commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+	_commandBuffers.resize(_framesInFlight);
+	_uploadCommandBuffers.resize(_framesInFlight);
+	_streamingFrames.resize(_framesInFlight);
 
 	VkCommandBufferAllocateInfo allocateInfo{};
 	allocateInfo.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -399,25 +626,117 @@ void VulkanInstance::create_command_buffers() {
 	allocateInfo.level				= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 	allocateInfo.commandBufferCount = static_cast<uint32_t>(_commandBuffers.size());
 
-	if (vkAllocateCommandBuffers(_device, &allocateInfo, _commandBuffers.data()) != VK_SUCCESS) {
+	if (vkAllocateCommandBuffers(_device, &allocateInfo, _commandBuffers.data()) != VK_SUCCESS ||
+		vkAllocateCommandBuffers(_device, &allocateInfo, _uploadCommandBuffers.data()) != VK_SUCCESS) {
 		throw std::runtime_error("couldn't allocate command buffer for current device");
 	}
 	std::cerr << "Created successfully command buffer for current device" << std::endl;
+
+	_secondaryCommandBuffers.resize(_secondaryCommandPools.size());
+	allocateInfo.level				= VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+	allocateInfo.commandBufferCount = 1;
+	for (size_t i = 0; i < _secondaryCommandPools.size(); i++) {
+		allocateInfo.commandPool = _secondaryCommandPools[i];
+		if (vkAllocateCommandBuffers(_device, &allocateInfo, &_secondaryCommandBuffers[i]) != VK_SUCCESS) {
+			throw std::runtime_error("couldn't allocate secondary command buffer for current device");
+		}
+	}
+	std::cerr << "Created successfully secondary command buffers for current device" << std::endl;
 }
 
-void VulkanInstance::create_descriptor_pool() {
-	std::array<VkDescriptorPoolSize, 2> poolSizes{};
-	poolSizes[0].type			 = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+VkCommandBuffer VulkanInstance::frame_command_buffer(const uint32_t image_idx, const uint32_t frame_idx) {
+	if (!_recordOnce) {
+		const VkCommandBuffer commandBuffer = _commandBuffers[frame_idx];
+		vkResetCommandBuffer(commandBuffer, 0);
+		record_command_buffer(commandBuffer, image_idx, frame_idx);
+		return commandBuffer;
+	}
+
+	// The swapchain may come back with another image count, its recreation waited for the device to idle
+	if (const size_t count = _swapchainImages.size() * _framesInFlight; _staticCommandBuffers.size() != count) {
+		if (!_staticCommandBuffers.empty())
+			vkFreeCommandBuffers(_device, _commandPool, _staticCommandBuffers.size(), _staticCommandBuffers.data());
+
+		VkCommandBufferAllocateInfo allocateInfo{};
+		allocateInfo.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocateInfo.commandPool		= _commandPool;
+		allocateInfo.level				= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocateInfo.commandBufferCount = static_cast<uint32_t>(count);
+
+		_staticCommandBuffers.resize(count);
+		if (vkAllocateCommandBuffers(_device, &allocateInfo, _staticCommandBuffers.data()) != VK_SUCCESS) {
+			throw std::runtime_error("couldn't allocate record-once command buffers for current device");
+		}
+		_staticCommandBuffersDirty.assign(count, true);
+		std::cerr << "Created successfully " << count << " record-once command buffers" << std::endl;
+	}
+
+	// Last submitted by this frame slot, whose fence was just waited on
+	const size_t		  index			= image_idx * _framesInFlight + frame_idx;
+	const VkCommandBuffer commandBuffer = _staticCommandBuffers[index];
+	if (_staticCommandBuffersDirty[index]) {
+		vkResetCommandBuffer(commandBuffer, 0);
+		record_command_buffer(commandBuffer, image_idx, frame_idx);
+		_staticCommandBuffersDirty[index] = false;
+	}
+	return commandBuffer;
+}
+
+void VulkanInstance::invalidate_command_buffers(const std::optional<uint32_t> frame) {
+	for (size_t i = 0; i < _staticCommandBuffersDirty.size(); i++) {
+		if (!frame || i % _framesInFlight == *frame)
+			_staticCommandBuffersDirty[i] = true;
+	}
+}
+
+void VulkanInstance::create_gpu_profiler(const VkPhysicalDevice &physical) {
+	const auto indices = find_queue_families(physical, _renderer->get_surface());
+	_gpuProfiler	   = std::make_unique<GpuProfiler>(_device, physical, indices.graphicsFamily.value(), _framesInFlight);
+}
+
+const FrameProfiler &VulkanInstance::profiler() const {
+	return _profiler;
+}
+
+bool VulkanInstance::headless() const {
+	return _offscreen.has_value();
+}
+
+bool VulkanInstance::textures_settled() const {
+	return _streamingSettled;
+}
+
+uint32_t VulkanInstance::max_texture_slots(const VkPhysicalDevice &physical) {
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(physical, &props);
+
+	const auto &limits = props.limits;
+	// The fragment stage's color attachment counts against its resources too
+	return std::max(1u, std::min({limits.maxPerStageDescriptorSamplers, limits.maxPerStageDescriptorSampledImages, limits.maxDescriptorSetSamplers,
+								  limits.maxDescriptorSetSampledImages, limits.maxPerStageResources - 1}));
+}
+
+uint32_t VulkanInstance::texture_groups() const {
+	return (static_cast<uint32_t>(_textures.size()) + _textureSlots - 1) / _textureSlots;
+}
 
-	poolSizes[1].type			 = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+void VulkanInstance::create_descriptor_pool() {
+	// One set per (frame, group of `_textureSlots` textures) pair, GPU-driven, one per frame for the culling pass, and with
+	// occlusion culling, one per level of the depth pyramid
+	const auto setCount	   = static_cast<uint32_t>(_framesInFlight * texture_groups());
+	auto	   poolSizes   = _pipeline->descriptor_pool_sizes(setCount);
+	const auto cullSets	   = gpu_driven() ? _framesInFlight : 0;
+	const auto pyramidSets = _occlusionCulling ? MAX_PYRAMID_LEVELS : 0;
+	if (gpu_driven())
+		std::ranges::copy(_cullPipeline->descriptor_pool_sizes(cullSets), std::back_inserter(poolSizes));
+	if (_occlusionCulling)
+		std::ranges::copy(_pyramidPipeline->descriptor_pool_sizes(pyramidSets), std::back_inserter(poolSizes));
 
 	VkDescriptorPoolCreateInfo createInfo{};
 	createInfo.sType		 = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 	createInfo.poolSizeCount = poolSizes.size();
 	createInfo.pPoolSizes	 = poolSizes.data();
-	createInfo.maxSets		 = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+	createInfo.maxSets		 = setCount + cullSets + pyramidSets;
 
 	if (vkCreateDescriptorPool(_device, &createInfo, nullptr, &_descriptorPool) != VK_SUCCESS) {
 		throw std::runtime_error("couldn't create new descriptor pool");
@@ -426,7 +745,8 @@ void VulkanInstance::create_descriptor_pool() {
 }
 
 void VulkanInstance::create_descriptor_sets() {
-	const std::vector			layouts(MAX_FRAMES_IN_FLIGHT, _pipeline->descriptorSetLayout);
+	const uint32_t				groups = texture_groups();
+	const std::vector			layouts(_framesInFlight * groups, _pipeline->descriptorSetLayout);
 
 	VkDescriptorSetAllocateInfo allocateInfo{};
 	allocateInfo.sType				= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
@@ -434,47 +754,134 @@ void VulkanInstance::create_descriptor_sets() {
 	allocateInfo.descriptorSetCount = layouts.size();
 	allocateInfo.pSetLayouts		= layouts.data();
 
-	_descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+	_descriptorSets.resize(layouts.size());
 	if (vkAllocateDescriptorSets(_device, &allocateInfo, _descriptorSets.data()) != VK_SUCCESS) {
 		throw std::runtime_error("couldn't allocate descriptor sets for current device");
 	}
 	std::cerr << "Allocated successfully descriptor sets for current device" << std::endl;
 
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-		VkDescriptorBufferInfo bufferInfo{};
-		bufferInfo.buffer = _uniformBuffers[i];
-		bufferInfo.offset = 0;
-		bufferInfo.range  = VK_WHOLE_SIZE;
+	// GPU-driven vertex shaders have no object uniforms, culling folded them into the instances
+	const size_t bufferBindings = gpu_driven() ? 1 : 2;
+	for (size_t i = 0; i < _descriptorSets.size(); i++) {
+		// The frame's uniforms, and those of an object at the dynamic offset given when binding the set
+		const std::array bufferInfos{
+			VkDescriptorBufferInfo{_uniformRing, frame_uniforms_offset(static_cast<uint32_t>(i / groups)), sizeof(FrameUniforms)},
+			VkDescriptorBufferInfo{_uniformRing, 0, sizeof(ObjectUniforms)},
+		};
+		constexpr std::array bindings{0u, OBJECT_UNIFORMS_BINDING};
+		constexpr std::array types{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC};
+
+		std::array<VkWriteDescriptorSet, bufferInfos.size()> writeDescriptors{};
+		for (size_t j = 0; j < bufferBindings; j++) {
+			writeDescriptors[j].sType			 = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writeDescriptors[j].dstSet			 = _descriptorSets[i];
+			writeDescriptors[j].dstBinding		 = bindings[j];
+			writeDescriptors[j].dstArrayElement	 = 0;
+			writeDescriptors[j].descriptorType	 = types[j];
+			writeDescriptors[j].descriptorCount	 = 1;
+			writeDescriptors[j].pBufferInfo		 = &bufferInfos[j];
+			writeDescriptors[j].pImageInfo		 = nullptr;
+			writeDescriptors[j].pTexelBufferView = nullptr;
+		}
+
+		vkUpdateDescriptorSets(_device, bufferBindings, writeDescriptors.data(), 0, nullptr);
+	}
+
+	if (gpu_driven()) {
+		const std::vector cullLayouts(_framesInFlight, _cullPipeline->descriptorSetLayout);
+		allocateInfo.descriptorSetCount = cullLayouts.size();
+		allocateInfo.pSetLayouts		= cullLayouts.data();
+
+		_cullDescriptorSets.resize(cullLayouts.size());
+		if (vkAllocateDescriptorSets(_device, &allocateInfo, _cullDescriptorSets.data()) != VK_SUCCESS) {
+			throw std::runtime_error("couldn't allocate culling descriptor sets for current device");
+		}
+
+		for (uint32_t frame = 0; frame < _framesInFlight; frame++) {
+			// In the order of shaders/cull.glsl's bindings, the pyramid's being written along with the pyramid
+			std::vector bufferInfos{
+				VkDescriptorBufferInfo{_cullBuffers.view.first, frame * _cullBuffers.viewRegionSize, _cullBuffers.viewRegionSize},
+				VkDescriptorBufferInfo{_cullBuffers.objects.first, 0, VK_WHOLE_SIZE},
+				VkDescriptorBufferInfo{_cullBuffers.objectDraws.first, 0, VK_WHOLE_SIZE},
+				VkDescriptorBufferInfo{_instanceBuffer, frame * _instanceRegionSize, _instanceRegionSize},
+				VkDescriptorBufferInfo{_cullBuffers.instanceObjects.first, 0, VK_WHOLE_SIZE},
+				VkDescriptorBufferInfo{_cullBuffers.draws.first, frame * _cullBuffers.drawsRegionSize, _cullBuffers.drawsRegionSize},
+				VkDescriptorBufferInfo{_cullBuffers.visible.first, frame * _cullBuffers.visibleRegionSize, _cullBuffers.visibleRegionSize},
+			};
+			if (_occlusionCulling)
+				bufferInfos.push_back({_cullBuffers.visibility.first, 0, VK_WHOLE_SIZE});
+
+			std::vector<VkWriteDescriptorSet> writeDescriptors(bufferInfos.size());
+			for (uint32_t j = 0; j < writeDescriptors.size(); j++) {
+				writeDescriptors[j].sType			= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writeDescriptors[j].dstSet			= _cullDescriptorSets[frame];
+				writeDescriptors[j].dstBinding		= j;
+				writeDescriptors[j].dstArrayElement = 0;
+				writeDescriptors[j].descriptorType	= VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				writeDescriptors[j].descriptorCount = 1;
+				writeDescriptors[j].pBufferInfo		= &bufferInfos[j];
+			}
+			vkUpdateDescriptorSets(_device, writeDescriptors.size(), writeDescriptors.data(), 0, nullptr);
+		}
+		std::cerr << "Updated culling descriptor sets" << std::endl;
+	}
 
-		VkDescriptorImageInfo imageInfo{};
-		imageInfo.sampler	  = _sampler;
-		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		imageInfo.imageView	  = _texImgView;
+	if (_occlusionCulling) {
+		const std::vector pyramidLayouts(MAX_PYRAMID_LEVELS, _pyramidPipeline->descriptorSetLayout);
+		allocateInfo.descriptorSetCount = pyramidLayouts.size();
+		allocateInfo.pSetLayouts		= pyramidLayouts.data();
 
-		std::array<VkWriteDescriptorSet, 2> writeDescriptors{};
-		writeDescriptors[0].sType			 = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		writeDescriptors[0].dstSet			 = _descriptorSets[i];
-		writeDescriptors[0].dstBinding		 = 0;
-		writeDescriptors[0].dstArrayElement	 = 0;
-		writeDescriptors[0].descriptorType	 = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		writeDescriptors[0].descriptorCount	 = 1;
-		writeDescriptors[0].pBufferInfo		 = &bufferInfo;
-		writeDescriptors[0].pImageInfo		 = nullptr;
-		writeDescriptors[0].pTexelBufferView = nullptr;
+		_pyramidDescriptorSets.resize(pyramidLayouts.size());
+		if (vkAllocateDescriptorSets(_device, &allocateInfo, _pyramidDescriptorSets.data()) != VK_SUCCESS) {
+			throw std::runtime_error("couldn't allocate depth pyramid descriptor sets for current device");
+		}
+		write_pyramid_descriptors();
+	}
 
-		writeDescriptors[1].sType			 = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		writeDescriptors[1].dstSet			 = _descriptorSets[i];
-		writeDescriptors[1].dstBinding		 = 1;
-		writeDescriptors[1].dstArrayElement	 = 0;
-		writeDescriptors[1].descriptorType	 = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		writeDescriptors[1].descriptorCount	 = 1;
-		writeDescriptors[1].pBufferInfo		 = nullptr;
-		writeDescriptors[1].pImageInfo		 = &imageInfo;
-		writeDescriptors[1].pTexelBufferView = nullptr;
+	_boundImages.resize(_framesInFlight * _textures.size());
+	for (uint32_t frame = 0; frame < _framesInFlight; frame++) {
+		for (uint32_t texture = 0; texture < _textures.size(); texture++)
+			write_texture_descriptor(frame, texture);
+		std::cerr << "Updated descriptor sets of frame " << frame << std::endl;
+	}
+}
 
-		vkUpdateDescriptorSets(_device, writeDescriptors.size(), writeDescriptors.data(), 0, nullptr);
-		std::cerr << "Updated descriptor set number " << i << std::endl;
+void VulkanInstance::write_texture_descriptor(const uint32_t frame, const uint32_t texture) {
+	const uint32_t groups = texture_groups();
+	const uint32_t group  = texture / _textureSlots;
+	const uint32_t slot	  = texture % _textureSlots;
+	const uint32_t used	  = std::min(_textureSlots, static_cast<uint32_t>(_textures.size()) - group * _textureSlots);
+	const uint32_t minLod = _streamer.resident(texture) - _streamer.base(texture);
+
+	VkDescriptorImageInfo imageInfo{};
+	imageInfo.sampler	  = _samplers[minLod];
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageInfo.imageView	  = _textures[texture].view;
+
+	// Slots past the last texture are never sampled but still have to be valid: they repeat the first texture of the set
+	const std::vector imageInfos(slot == 0 ? std::max(1u, _textureSlots - used) : 1, imageInfo);
+
+	std::vector<VkWriteDescriptorSet> writeDescriptors(slot == 0 && used < _textureSlots ? 2 : 1);
+	for (auto &writeDescriptor : writeDescriptors) {
+		writeDescriptor.sType			 = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writeDescriptor.dstSet			 = _descriptorSets[frame * groups + group];
+		writeDescriptor.dstBinding		 = 1;
+		writeDescriptor.dstArrayElement	 = slot;
+		writeDescriptor.descriptorType	 = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		writeDescriptor.descriptorCount	 = 1;
+		writeDescriptor.pBufferInfo		 = nullptr;
+		writeDescriptor.pImageInfo		 = imageInfos.data();
+		writeDescriptor.pTexelBufferView = nullptr;
+	}
+	if (writeDescriptors.size() > 1) {
+		writeDescriptors[1].dstArrayElement = used;
+		writeDescriptors[1].descriptorCount = _textureSlots - used;
 	}
+
+	vkUpdateDescriptorSets(_device, writeDescriptors.size(), writeDescriptors.data(), 0, nullptr);
+	_boundImages[frame * _textures.size() + texture] = {imageInfo.imageView, minLod};
+	// Command buffers binding the set are invalidated by the update
+	invalidate_command_buffers(frame);
 }
 
 
@@ -501,9 +908,85 @@ void VulkanInstance::record_command_buffer(const VkCommandBuffer command_buffer,
 	renderPassInfo.clearValueCount	 = clearValues.size();
 	renderPassInfo.pClearValues		 = clearValues.data();
 
-	vkCmdBeginRenderPass(command_buffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline->pipeline);
+	// Below that many batches per thread, handing them out costs more than recording them inline. Record-once buffers are
+	// recorded inline too: they outlive the secondary buffers, which are reset every frame. GPU-driven, there are only a
+	// few indirect draws to record, over every batch.
+	constexpr size_t MIN_BATCHES_PER_THREAD = 256;
+	const auto		&batches = gpu_driven() ? _batches : _frameBatches[frame_idx];
+	const auto		 threads = _recordOnce || gpu_driven()
+								   ? 1u
+								   : static_cast<uint32_t>(std::min<size_t>(_recordThreads, batches.size() / MIN_BATCHES_PER_THREAD));
+
+	if (gpu_driven())
+		record_cull_pass(command_buffer, frame_idx);
+
+	// With occlusion culling, the pass spans both render passes and what is between them
+	_gpuProfiler->begin(command_buffer, frame_idx, GpuProfiler::Pass::RENDER_PASS);
+	if (_occlusionCulling) {
+		// What was visible last frame first, whose depth hides what the pyramid built from it is then tested against: the
+		// second pass only draws what it finds visible that the first didn't draw
+		renderPassInfo.renderPass = _pipeline->earlyRenderPass;
+		vkCmdBeginRenderPass(command_buffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		record_draws(command_buffer, frame_idx, batches);
+		vkCmdEndRenderPass(command_buffer);
+
+		record_depth_pyramid(command_buffer);
+		record_cull_pass(command_buffer, frame_idx, true);
+
+		renderPassInfo.renderPass = _pipeline->renderPass;
+		vkCmdBeginRenderPass(command_buffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		record_draws(command_buffer, frame_idx, batches, true);
+	} else if (threads <= 1) {
+		vkCmdBeginRenderPass(command_buffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		record_draws(command_buffer, frame_idx, batches);
+	} else {
+		vkCmdBeginRenderPass(command_buffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+		// Pipelines are created on first use, which only this thread may do: batches being sorted untextured first, the
+		// first and last ones name every variant drawn
+		(void)_pipeline->get({.textured = batches.front().texture.has_value()});
+		(void)_pipeline->get({.textured = batches.back().texture.has_value()});
+
+		VkCommandBufferInheritanceInfo inheritanceInfo{};
+		inheritanceInfo.sType		= VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.renderPass	= _pipeline->renderPass;
+		inheritanceInfo.subpass		= 0;
+		inheritanceInfo.framebuffer = _framebuffers[image_idx];
+
+		// Contiguous ranges keep each thread's pipeline and descriptor set changes as few as they were in a single buffer
+		const std::span secondaries(_secondaryCommandBuffers.data() + frame_idx * _recordThreads, threads);
+		_recordPool->parallel_for(threads, [&](const size_t thread) {
+			vkResetCommandPool(_device, _secondaryCommandPools[frame_idx * _recordThreads + thread], 0);
+
+			VkCommandBufferBeginInfo secondaryBeginInfo{};
+			secondaryBeginInfo.sType			= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			secondaryBeginInfo.flags			= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			secondaryBeginInfo.pInheritanceInfo = &inheritanceInfo;
+			if (vkBeginCommandBuffer(secondaries[thread], &secondaryBeginInfo) != VK_SUCCESS) {
+				throw std::runtime_error("couldn't begin secondary command buffer");
+			}
+
+			const size_t first = batches.size() * thread / threads;
+			const size_t last  = batches.size() * (thread + 1) / threads;
+			record_draws(secondaries[thread], frame_idx, std::span(batches).subspan(first, last - first));
+
+			if (vkEndCommandBuffer(secondaries[thread]) != VK_SUCCESS) {
+				throw std::runtime_error("couldn't record secondary command buffer");
+			}
+		});
+		vkCmdExecuteCommands(command_buffer, threads, secondaries.data());
+	}
+
+	vkCmdEndRenderPass(command_buffer);
+	_gpuProfiler->end(command_buffer, frame_idx, GpuProfiler::Pass::RENDER_PASS);
+
+	if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+		throw std::runtime_error("couldn't record command buffer");
+	}
+}
 
+void VulkanInstance::record_draws(const VkCommandBuffer command_buffer, const uint32_t frame_idx, const std::span<const DrawBatch> batches,
+								  const bool late) const {
 	VkViewport viewport{};
 	viewport.x		  = 0.0F;
 	viewport.y		  = 0.0F;
@@ -518,17 +1001,75 @@ void VulkanInstance::record_command_buffer(const VkCommandBuffer command_buffer,
 	scissor.extent = _swapchainExtent;
 	vkCmdSetScissor(command_buffer, 0, 1, &scissor);
 
-	const std::array								   buffers{_vertexBuffer};
-	constexpr std::array<VkDeviceSize, buffers.size()> offsets{0};
+	// Instances are read from the frame's region, which culling filled
+	const std::array buffers{_vertexBuffer, gpu_driven() ? _cullBuffers.visible.first : _instanceBuffer};
+	const std::array<VkDeviceSize, buffers.size()> offsets{0, frame_idx * (gpu_driven() ? _cullBuffers.visibleRegionSize : _instanceRegionSize)};
 	vkCmdBindVertexBuffers(command_buffer, 0, buffers.size(), buffers.data(), offsets.data());
 	vkCmdBindIndexBuffer(command_buffer, _indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline->layout, 0, 1, &_descriptorSets[frame_idx], 0, nullptr);
-	vkCmdDrawIndexed(command_buffer, _indices.size(), 1, 0, 0, 0);
 
-	vkCmdEndRenderPass(command_buffer);
+	const uint32_t groups = texture_groups();
+	if (gpu_driven()) {
+		// Draw commands follow the batches, whose sorting puts those sharing a texture, and so every bound state, next to
+		// each other: one indirect draw covers them. The second render pass's follow the first's.
+		constexpr VkDeviceSize		   stride = sizeof(VkDrawIndexedIndirectCommand);
+		const auto					   first  = static_cast<VkDeviceSize>(batches.data() - _batches.data() + (late ? _batches.size() : 0));
+		std::optional<PipelineVariant> boundVariant;
+		std::optional<uint32_t>		   boundGroup;
+		for (size_t begin = 0, end; begin < batches.size(); begin = end) {
+			const auto &texture = batches[begin].texture;
+			for (end = begin + 1; end < batches.size() && batches[end].texture == texture;)
+				end++;
+
+			const PipelineVariant variant{.textured = texture.has_value()};
+			if (boundVariant != variant) {
+				vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline->get(variant));
+				boundVariant = variant;
+			}
+			const uint32_t group = texture.value_or(0) / _textureSlots;
+			const uint32_t slot	 = texture.value_or(0) % _textureSlots;
+			if (boundGroup != group) {
+				const auto &set = _descriptorSets[frame_idx * groups + group];
+				vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline->layout, 0, 1, &set, 0, nullptr);
+				boundGroup = group;
+			}
+			if (texture)
+				vkCmdPushConstants(command_buffer, _pipeline->layout, _pipeline->pushConstantStages, 0, sizeof(slot), &slot);
+
+			// As many commands at once as the device takes, one without multiDrawIndirect
+			const VkDeviceSize offset = frame_idx * _cullBuffers.drawsRegionSize + (first + begin) * stride;
+			const auto		   count  = static_cast<uint32_t>(end - begin);
+			for (uint32_t i = 0; i < count; i += _maxDrawIndirectCount)
+				vkCmdDrawIndexedIndirect(command_buffer, _cullBuffers.draws.first, offset + i * stride, std::min(count - i, _maxDrawIndirectCount), stride);
+		}
+		return;
+	}
 
-	if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
-		throw std::runtime_error("couldn't record command buffer");
+	// Batches are sorted by texture, untextured ones first, then by object, so the pipeline changes at most once and the
+	// descriptor set is only bound again between groups of `_textureSlots` textures or, at another dynamic offset, between
+	// objects: a draw otherwise only pushes the slot of its texture
+	std::optional<PipelineVariant> boundVariant;
+	std::optional<uint32_t>		   boundGroup;
+	std::optional<uint32_t>		   boundObject;
+	for (const auto &[texture, object, firstIndex, indexCount, firstInstance, instanceCount] : batches) {
+		const PipelineVariant variant{.textured = texture.has_value()};
+		if (boundVariant != variant) {
+			vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline->get(variant));
+			boundVariant = variant;
+		}
+
+		// The UBO is in every set, untextured draws bind the first one
+		const uint32_t group = texture.value_or(0) / _textureSlots;
+		const uint32_t slot	 = texture.value_or(0) % _textureSlots;
+		if (boundGroup != group || boundObject != object) {
+			const auto	  &set	  = _descriptorSets[frame_idx * groups + group];
+			const auto	   offset = static_cast<uint32_t>(object_uniforms_offset(frame_idx, object));
+			vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline->layout, 0, 1, &set, 1, &offset);
+			boundGroup	= group;
+			boundObject = object;
+		}
+		if (texture)
+			vkCmdPushConstants(command_buffer, _pipeline->layout, _pipeline->pushConstantStages, 0, sizeof(slot), &slot);
+		vkCmdDrawIndexed(command_buffer, indexCount, instanceCount, firstIndex, 0, firstInstance);
 	}
 }
 
@@ -540,11 +1081,11 @@ void VulkanInstance::create_sync_objects() {
 	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 	fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-	_imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-	_renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-	_inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+	_imageAvailableSemaphores.resize(_framesInFlight);
+	_renderFinishedSemaphores.resize(_framesInFlight);
+	_inFlightFences.resize(_framesInFlight);
 
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+	for (size_t i = 0; i < _framesInFlight; i++) {
 		if (vkCreateSemaphore(_device, &semaphoreCreateInfo, nullptr, &_imageAvailableSemaphores[i]) != VK_SUCCESS ||
 			vkCreateSemaphore(_device, &semaphoreCreateInfo, nullptr, &_renderFinishedSemaphores[i]) != VK_SUCCESS) {
 			throw std::runtime_error("couldn't create semaphore[" + std::to_string(i) + "] for device");
@@ -619,10 +1160,123 @@ void VulkanInstance::create_index_buffer(const VkPhysicalDevice &physical) {
 	vkFreeMemory(_device, stagingMemory, nullptr);
 }
 
+void VulkanInstance::create_instance_buffer(const VkPhysicalDevice &physical) {
+	constexpr VkBufferUsageFlags	usage	   = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	constexpr VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+	VkPhysicalDeviceProperties		props;
+	vkGetPhysicalDeviceProperties(physical, &props);
+
+	// Regions are bound as storage buffers by the culling pass
+	const VkDeviceSize alignment  = props.limits.minStorageBufferOffsetAlignment;
+	const VkDeviceSize size		  = sizeof(_instances[0]) * std::max<size_t>(1, _instances.size());
+	_instanceRegionSize			  = (size + alignment - 1) / alignment * alignment;
+	const VkDeviceSize bufferSize = _instanceRegionSize * _framesInFlight;
+
+	std::tie(_instanceBuffer, _instanceBufferMemory) = create_buffer(physical, bufferSize, usage, properties);
+	void *mapped;
+	vkMapMemory(_device, _instanceBufferMemory, 0, bufferSize, 0, &mapped);
+	_instanceBufferMapped = static_cast<uint8_t *>(mapped);
+	std::cerr << "Created successfully instance buffer of " << bufferSize << " bytes for " << _instances.size() << " instances" << std::endl;
+
+	// GPU-driven, regions hold every instance in order, kept up to date by move_instance rather than rewritten each frame
+	_pendingMoves.assign(_framesInFlight, {});
+	if (gpu_driven()) {
+		for (uint32_t frame = 0; frame < _framesInFlight; frame++)
+			memcpy(_instanceBufferMapped + frame * _instanceRegionSize, _instances.data(), sizeof(_instances[0]) * _instances.size());
+	}
+}
+
+std::pair<VkBuffer, VkDeviceMemory> VulkanInstance::create_static_buffer(const VkPhysicalDevice &physical, const void *data, const VkDeviceSize size,
+																		 const VkBufferUsageFlags usage) const {
+	// Empty buffers can't be created, nor bound
+	const VkDeviceSize bufferSize = std::max<VkDeviceSize>(size, 4);
+
+	auto [stagingBuffer, stagingMemory] =
+		create_buffer(physical, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	void *mapped;
+	vkMapMemory(_device, stagingMemory, 0, bufferSize, 0, &mapped);
+	memcpy(mapped, data, size);
+	vkUnmapMemory(_device, stagingMemory);
+
+	const auto ret = create_buffer(physical, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	copy_buffer(stagingBuffer, ret.first, bufferSize);
+
+	vkDestroyBuffer(_device, stagingBuffer, nullptr);
+	vkFreeMemory(_device, stagingMemory, nullptr);
+	return ret;
+}
+
+void VulkanInstance::create_cull_buffers(const VkPhysicalDevice &physical) {
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(physical, &props);
+	const VkDeviceSize alignment = props.limits.minStorageBufferOffsetAlignment;
+	const auto		   align	 = [alignment](const VkDeviceSize size) { return (size + alignment - 1) / alignment * alignment; };
+
+	// Draws are listed by object, those of an object after the previous ones'. Each batch gets room for every instance of
+	// its object in `visible`, its command's firstInstance being where that room starts.
+	std::vector<std::vector<uint32_t>>			draws(_objects.size());
+	std::vector<VkDrawIndexedIndirectCommand>	commands;
+	uint32_t									visibleSlots = 0;
+	for (uint32_t i = 0; i < _batches.size(); i++) {
+		const auto &batch = _batches[i];
+		draws[batch.object].push_back(i);
+		commands.push_back({batch.indexCount, 0, batch.firstIndex, 0, visibleSlots});
+		visibleSlots += batch.instanceCount;
+	}
+
+	// With occlusion culling, the second render pass's commands follow, their room after the first's
+	if (_occlusionCulling) {
+		for (size_t i = 0; i < _batches.size(); i++) {
+			auto command = commands[i];
+			command.firstInstance += visibleSlots;
+			commands.push_back(command);
+		}
+		visibleSlots *= 2;
+	}
+
+	std::vector<CullObject> objects;
+	std::vector<uint32_t>	objectDraws;
+	for (uint32_t object = 0; object < _objects.size(); object++) {
+		const auto &bounds = _objectBounds[object];
+		objects.push_back({bounds.min, static_cast<uint32_t>(objectDraws.size()), bounds.max, static_cast<uint32_t>(draws[object].size())});
+		objectDraws.insert(objectDraws.end(), draws[object].begin(), draws[object].end());
+	}
+
+	constexpr VkBufferUsageFlags storage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	_cullBuffers.objects				 = create_static_buffer(physical, objects.data(), sizeof(objects[0]) * objects.size(), storage);
+	_cullBuffers.objectDraws			 = create_static_buffer(physical, objectDraws.data(), sizeof(objectDraws[0]) * objectDraws.size(), storage);
+	_cullBuffers.instanceObjects =
+		create_static_buffer(physical, _instanceObjects.data(), sizeof(_instanceObjects[0]) * _instanceObjects.size(), storage);
+	_cullBuffers.initialDraws = create_static_buffer(physical, commands.data(), sizeof(commands[0]) * commands.size(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+	if (_occlusionCulling) {
+		// Nothing was visible before the first frame, whose first pass then draws nothing and second everything it sees
+		const std::vector<uint32_t> visibility(_instances.size(), 0);
+		_cullBuffers.visibility = create_static_buffer(physical, visibility.data(), sizeof(visibility[0]) * visibility.size(), storage);
+	}
+
+	_cullBuffers.viewRegionSize	   = align(sizeof(CullUniforms) + sizeof(maths::Mat4) * _objects.size());
+	_cullBuffers.drawsRegionSize   = align(sizeof(VkDrawIndexedIndirectCommand) * std::max<size_t>(1, commands.size()));
+	_cullBuffers.visibleRegionSize = align(sizeof(maths::Mat4) * std::max(1u, visibleSlots));
+
+	_cullBuffers.view = create_buffer(physical, _cullBuffers.viewRegionSize * _framesInFlight, storage,
+									  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	void *mapped;
+	vkMapMemory(_device, _cullBuffers.view.second, 0, _cullBuffers.viewRegionSize * _framesInFlight, 0, &mapped);
+	_cullBuffers.viewMapped = static_cast<uint8_t *>(mapped);
+
+	_cullBuffers.draws	 = create_buffer(physical, _cullBuffers.drawsRegionSize * _framesInFlight,
+										 storage | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	_cullBuffers.visible = create_buffer(physical, _cullBuffers.visibleRegionSize * _framesInFlight, storage | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+										 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	std::cerr << "Created successfully culling buffers for " << commands.size() << " draws of up to " << visibleSlots << " instances" << std::endl;
+}
+
 void VulkanInstance::create_depth_img(const VkPhysicalDevice &physical) {
-	const VkFormat					format		= find_depth_format(physical);
+	const VkFormat					format		= find_depth_format(physical, _occlusionCulling);
 	constexpr VkImageTiling			tiling		= VK_IMAGE_TILING_OPTIMAL;
-	constexpr VkImageUsageFlags		usage		= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+	// Occlusion culling reduces it into the pyramid between its two render passes
+	const VkImageUsageFlags			usage		= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | (_occlusionCulling ? VK_IMAGE_USAGE_SAMPLED_BIT : 0);
 	constexpr VkMemoryPropertyFlags props		= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 	constexpr VkImageAspectFlags	aspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT;
 
@@ -637,18 +1291,142 @@ void VulkanInstance::create_depth_img(const VkPhysicalDevice &physical) {
 	_depthImgView = *ret;
 
 	transition_image_layout(_depthImg, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, 1);
+
+	if (_occlusionCulling)
+		create_depth_pyramid(physical);
 }
 
 
-void VulkanInstance::create_texture_object(const VkPhysicalDevice &physical, std::string path) {
-	_tex = resources::Texture::load(std::move(path));
+void VulkanInstance::set_geometry(geometry::Mesh mesh, const std::vector<std::optional<uint32_t>> &materialTextures,
+								  std::vector<SceneObject> objects) {
+	_vertices = std::move(mesh.vertices);
+	_indices  = std::move(mesh.indices);
+	_objects  = std::move(objects);
+
+	_batches.clear();
+	_batches.reserve(mesh.submeshes.size());
+	_instances.clear();
+	_instanceObjects.clear();
+	_firstInstances.clear();
+	_objectBounds.assign(_objects.size(), {});
+	std::vector<geometry::Aabb> instanceBounds;
+	for (uint32_t object = 0; object < _objects.size(); object++) {
+		const auto &[firstSubmesh, submeshCount, transform, instances] = _objects[object];
+		const auto	firstInstance										= static_cast<uint32_t>(_instances.size());
+		_firstInstances.push_back(firstInstance);
+		_instances.insert(_instances.end(), instances.begin(), instances.end());
+		_instanceObjects.insert(_instanceObjects.end(), instances.size(), object);
+
+		for (const auto &submesh : std::span(mesh.submeshes).subspan(firstSubmesh, submeshCount)) {
+			_batches.push_back({materialTextures.at(submesh.material), object, submesh.first_index, submesh.index_count, firstInstance,
+								static_cast<uint32_t>(instances.size())});
+			for (uint32_t i = submesh.first_index; i < submesh.first_index + submesh.index_count; i++)
+				_objectBounds[object].grow(_vertices[_indices[i]].position);
+		}
+		for (const auto &instance : instances)
+			instanceBounds.push_back(_objectBounds[object].transformed(instance * transform));
+	}
+	_bvh = geometry::Bvh(instanceBounds);
+	_frameBatches.assign(_framesInFlight, {});
+
+	std::ranges::stable_sort(_batches, {}, [](const DrawBatch &batch) { return std::pair(batch.texture, batch.object); });
+
+	// Submeshes of different materials sharing a texture are drawn at once when their indices follow each other
+	std::vector<DrawBatch> merged;
+	for (const auto &batch : _batches) {
+		if (!merged.empty() && merged.back().texture == batch.texture && merged.back().object == batch.object &&
+			merged.back().firstIndex + merged.back().indexCount == batch.firstIndex)
+			merged.back().indexCount += batch.indexCount;
+		else
+			merged.push_back(batch);
+	}
+	_batches = std::move(merged);
+	invalidate_command_buffers();
+	std::cerr << "Prepared " << _batches.size() << " draw batches of " << _instances.size() << " instances" << std::endl;
+
+	using Box = std::pair<maths::Vec3, maths::Vec3>;
+	auto grow = [](std::optional<Box> &box, const maths::Vec3 &p) {
+		if (!box)
+			box = {p, p};
+		box->first	= maths::Vec3(std::min(box->first.x(), p.x()), std::min(box->first.y(), p.y()), std::min(box->first.z(), p.z()));
+		box->second = maths::Vec3(std::max(box->second.x(), p.x()), std::max(box->second.y(), p.y()), std::max(box->second.z(), p.z()));
+	};
+
+	// Textures drawn by no batch keep a negative radius and are never streamed past their mip tail. Bounds are taken
+	// around every instance as placed in the scene, from the corners of the batch's own box rather than all its vertices
+	// again for each instance.
+	_textureBounds.assign(_textures.size(), {maths::Vec3(), -1.0f});
+	for (uint32_t texture = 0; texture < _textures.size(); texture++) {
+		std::optional<Box> box;
+		for (const auto &batch : _batches) {
+			if (batch.texture != texture)
+				continue;
+
+			std::optional<Box> local;
+			for (uint32_t i = batch.firstIndex; i < batch.firstIndex + batch.indexCount; i++)
+				grow(local, _vertices[_indices[i]].position);
+			if (!local)
+				continue;
+
+			const auto &[low, high] = *local;
+			const auto &object		= _objects[batch.object];
+			for (const auto &instance : object.instances) {
+				const auto placement = instance * object.transform;
+				for (uint32_t corner = 0; corner < 8; corner++) {
+					grow(box, placement.transform_point(maths::Vec3(corner & 1 ? high.x() : low.x(), corner & 2 ? high.y() : low.y(),
+																   corner & 4 ? high.z() : low.z())));
+				}
+			}
+		}
+		if (!box)
+			continue;
+
+		const auto center = (box->first + box->second) * 0.5f;
+		const auto extent = box->second - center;
+		_textureBounds[texture] = {center, std::sqrt(extent * extent)};
+	}
+}
 
-	if (!_tex) {
-		throw std::runtime_error("couldn't load image from file");
+void VulkanInstance::create_texture_objects(const VkPhysicalDevice &physical, const std::vector<resources::Texture> &textures) {
+	_textures.reserve(textures.size());
+	for (auto texture : textures) {
+		if (!texture) {
+			throw std::runtime_error("couldn't load image from file");
+		}
+
+		// Uncompressed textures loaded without their mip chain get it blitted on the GPU, or built on the CPU when the
+		// format can't be linearly filtered by vkCmdBlitImage
+		bool generateMips = texture.levels == 1 && !texture.compressed();
+		if (generateMips && !supports_linear_blit(physical, vk_format(texture.format))) {
+			texture		 = assets::generate_mips(texture);
+			generateMips = false;
+		}
+
+		// Only chains held on the CPU can be streamed, a blitted one is registered as its single source level
+		const uint32_t index = _streamer.add(texture);
+		_textures.push_back(create_texture_object(physical, texture, generateMips, _streamer.base(index)));
 	}
-	_mipLevels								   = static_cast<uint32_t>(std::floorf(std::log2f(std::max(_tex.w, _tex.h)))) + 1;
+	std::cerr << "Created successfully " << _textures.size() << " texture objects, " << _streamer.allocated_bytes() / 1024
+			  << " KiB of mip tails resident" << std::endl;
+}
+
+bool VulkanInstance::supports_texture_format(const VkPhysicalDevice &physical, const resources::Texture::Format format) {
+	constexpr VkFormatFeatureFlags features = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+	// RGBA8 is the last resort every device supports, being handed it back means `format` isn't usable
+	const VkFormat				   wanted	= vk_format(format);
+	return find_supported_format(physical, {wanted, VK_FORMAT_R8G8B8A8_SRGB}, VK_IMAGE_TILING_OPTIMAL, features) == wanted;
+}
+
+TextureObject VulkanInstance::create_texture_object(const VkPhysicalDevice &physical, const resources::Texture &texture, const bool generateMips,
+													const uint32_t base) const {
+	TextureObject obj{};
+	obj.mipLevels							   = generateMips ? resources::Texture::mip_count(texture.w, texture.h) : texture.levels - base;
+	obj.format								   = vk_format(texture.format);
+	obj.source								   = texture;
 
-	const VkDeviceSize				deviceSize = _tex.device_size();
+	const size_t					offset	   = texture.level_offset(base);
+	const VkDeviceSize				deviceSize = texture.device_size() - offset;
 
 	constexpr VkBufferUsageFlags	usage	   = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 	constexpr VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
@@ -656,34 +1434,48 @@ void VulkanInstance::create_texture_object(const VkPhysicalDevice &physical, std
 
 	void *data;
 	vkMapMemory(_device, stagingMemory, 0, deviceSize, 0, &data);
-	memcpy(data, _tex.pixels.get(), deviceSize);
+	memcpy(data, texture.pixels.get() + offset, deviceSize);
 	vkUnmapMemory(_device, stagingMemory);
 
-	constexpr VkFormat				format	   = VK_FORMAT_R8G8B8A8_SRGB;
+	const VkFormat					format	   = obj.format;
 	constexpr VkImageTiling			tiling	   = VK_IMAGE_TILING_OPTIMAL;
 	constexpr VkImageUsageFlags		imgUsage   = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 	constexpr VkMemoryPropertyFlags props	   = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
-	std::tie(_texImg, _texImgMemory)		   = create_image(physical, _tex.w, _tex.h, _mipLevels, VK_SAMPLE_COUNT_1_BIT, format, tiling, imgUsage, props);
+	std::tie(obj.img, obj.memory) = create_image(physical, texture.level_width(base), texture.level_height(base), obj.mipLevels, VK_SAMPLE_COUNT_1_BIT, format,
+												 tiling, imgUsage, props);
 
 	constexpr VkImageLayout oldLayout		   = VK_IMAGE_LAYOUT_UNDEFINED;
 	constexpr VkImageLayout transitionalLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
 
-	transition_image_layout(_texImg, format, oldLayout, transitionalLayout, _mipLevels);
-	copy_buffer_to_image(stagingBuffer, _texImg, _tex.w, _tex.h);
-	generate_mip_maps(physical, _texImg, format, _tex.w, _tex.h, _mipLevels);
+	transition_image_layout(obj.img, format, oldLayout, transitionalLayout, obj.mipLevels);
+	copy_buffer_to_image(stagingBuffer, obj.img, texture, base);
+	if (generateMips)
+		generate_mip_maps(physical, obj.img, format, texture.w, texture.h, obj.mipLevels);
+	else
+		transition_image_layout(obj.img, format, transitionalLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, obj.mipLevels);
 
 	vkDestroyBuffer(_device, stagingBuffer, nullptr);
 	vkFreeMemory(_device, stagingMemory, nullptr);
+
+	return obj;
 }
 
-void VulkanInstance::create_tex_img_view() {
-	const auto ret = create_image_view(_texImg, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, _mipLevels);
-	if (!ret) {
-		throw std::runtime_error("couldn't create image view for main texture");
+void VulkanInstance::destroy_texture_object(const TextureObject &texture) const {
+	vkDestroyImageView(_device, texture.view, nullptr);
+	vkDestroyImage(_device, texture.img, nullptr);
+	vkFreeMemory(_device, texture.memory, nullptr);
+}
+
+void VulkanInstance::create_tex_img_views() {
+	for (size_t i = 0; i < _textures.size(); i++) {
+		const auto ret = create_image_view(_textures[i].img, _textures[i].format, VK_IMAGE_ASPECT_COLOR_BIT, _textures[i].mipLevels);
+		if (!ret) {
+			throw std::runtime_error("couldn't create image view for texture " + std::to_string(i));
+		}
+		_textures[i].view = *ret;
 	}
-	std::cerr << "Created successfully image view for main texture" << std::endl;
-	_texImgView = *ret;
+	std::cerr << "Created successfully image views for all textures" << std::endl;
 }
 
 void VulkanInstance::create_tex_sampler(const VkPhysicalDevice &physical) {
@@ -705,13 +1497,18 @@ void VulkanInstance::create_tex_sampler(const VkPhysicalDevice &physical) {
 	createInfo.compareOp			   = VK_COMPARE_OP_ALWAYS;
 	createInfo.mipmapMode			   = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 	createInfo.mipLodBias			   = 0.0f;
-	createInfo.minLod				   = 0.0f;
-	createInfo.maxLod				   = static_cast<float>(_mipLevels);
-
-	if (vkCreateSampler(_device, &createInfo, nullptr, &_sampler) != VK_SUCCESS) {
-		throw std::runtime_error("couldn't create texture sampler");
+	createInfo.maxLod				   = VK_LOD_CLAMP_NONE;
+
+	// One per level a streamed texture may be clamped to, the views starting at the texture's allocated base
+	const auto maxLevels			   = std::ranges::max(_textures, {}, [](const TextureObject &texture) { return texture.source.levels; }).source.levels;
+	_samplers.resize(maxLevels);
+	for (uint32_t minLod = 0; minLod < maxLevels; minLod++) {
+		createInfo.minLod = static_cast<float>(minLod);
+		if (vkCreateSampler(_device, &createInfo, nullptr, &_samplers[minLod]) != VK_SUCCESS) {
+			throw std::runtime_error("couldn't create texture sampler");
+		}
 	}
-	std::cerr << "Created successfully texture sampler" << std::endl;
+	std::cerr << "Created successfully " << _samplers.size() << " texture samplers" << std::endl;
 }
 
 void VulkanInstance::create_color_resources(const VkPhysicalDevice &physical) {
@@ -821,14 +1618,14 @@ std::pair<VkImage, VkDeviceMemory> VulkanInstance::create_image(const VkPhysical
 }
 
 std::optional<VkImageView> VulkanInstance::create_image_view(const VkImage image, const VkFormat format, const VkImageAspectFlags &aspectFlags,
-															 const uint32_t mipLevels) const {
+															 const uint32_t mipLevels, const uint32_t baseLevel) const {
 	VkImageViewCreateInfo createInfo{};
 	createInfo.sType						   = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 	createInfo.image						   = image;
 	createInfo.viewType						   = VK_IMAGE_VIEW_TYPE_2D;
 	createInfo.format						   = format;
 	createInfo.subresourceRange.aspectMask	   = aspectFlags;
-	createInfo.subresourceRange.baseMipLevel   = 0;
+	createInfo.subresourceRange.baseMipLevel   = baseLevel;
 	createInfo.subresourceRange.levelCount	   = mipLevels;
 	createInfo.subresourceRange.baseArrayLayer = 0;
 	createInfo.subresourceRange.layerCount	   = 1;
@@ -946,6 +1743,12 @@ void VulkanInstance::transition_image_layout(const VkImage image, const VkFormat
 
 		srcStage			  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 		dstStage			  = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	} else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_GENERAL) {
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+		srcStage			  = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		dstStage			  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
 	} else {
 		throw std::invalid_argument("unsupported layout transition");
 	}
@@ -965,34 +1768,39 @@ void VulkanInstance::transition_image_layout(const VkImage image, const VkFormat
 	end_single_time_command(cmdBuffer);
 }
 
-void VulkanInstance::copy_buffer_to_image(const VkBuffer buffer, const VkImage image, const uint32_t w, const uint32_t h) const {
-	const VkCommandBuffer cmdBuffer = begin_single_time_command();
-
-	VkBufferImageCopy	  region{};
-	region.bufferOffset					   = 0;
-	region.bufferRowLength				   = 0;
-	region.bufferImageHeight			   = 0;
-
-	region.imageSubresource.aspectMask	   = VK_IMAGE_ASPECT_COLOR_BIT;
-	region.imageSubresource.mipLevel	   = 0;
-	region.imageSubresource.baseArrayLayer = 0;
-	region.imageSubresource.layerCount	   = 1;
-
-	region.imageOffset					   = {0, 0, 0};
-	region.imageExtent					   = {w, h, 1};
+void VulkanInstance::copy_buffer_to_image(const VkBuffer buffer, const VkImage image, const resources::Texture &texture, const uint32_t base) const {
+	const VkCommandBuffer		   cmdBuffer = begin_single_time_command();
+
+	// One region per mip level present in the staging buffer, all uploaded by a single copy; the staging buffer and
+	// the image both start at level `base`
+	std::vector<VkBufferImageCopy> regions(texture.levels - base);
+	for (uint32_t level = base; level < texture.levels; level++) {
+		auto &region							   = regions[level - base];
+		region.bufferOffset						   = texture.level_offset(level) - texture.level_offset(base);
+		region.bufferRowLength					   = 0;
+		region.bufferImageHeight				   = 0;
+
+		region.imageSubresource.aspectMask		   = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel		   = level - base;
+		region.imageSubresource.baseArrayLayer	   = 0;
+		region.imageSubresource.layerCount		   = 1;
+
+		region.imageOffset						   = {0, 0, 0};
+		region.imageExtent						   = {static_cast<uint32_t>(texture.level_width(level)), static_cast<uint32_t>(texture.level_height(level)), 1};
+	}
 
-	vkCmdCopyBufferToImage(cmdBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+	vkCmdCopyBufferToImage(cmdBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regions.size(), regions.data());
 
 	end_single_time_command(cmdBuffer);
 }
 
-VkFormat VulkanInstance::find_depth_format(const VkPhysicalDevice &physical) {
+VkFormat VulkanInstance::find_depth_format(const VkPhysicalDevice &physical, const bool sampled) {
 	// clang-format off
 	return find_supported_format(
 		physical,
 		{VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
 		VK_IMAGE_TILING_OPTIMAL,
-		VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
+		VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | (sampled ? VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT : 0)
 	);
 	// clang-format on
 }
@@ -1015,49 +1823,16 @@ VkFormat VulkanInstance::find_supported_format(const VkPhysicalDevice &physical,
 }
 
 
-void VulkanInstance::init_geometry() {
-	_vertices.clear();
-	_indices.clear();
-
-	std::unordered_map<VertexData, size_t> index_cache;
-
-	for (const auto &face : parser::file) {
-		for (const auto &vertIndices : face.vertices) {
-			VertexData vertexData;
-			vertexData.color		= maths::Vec3{1.0f, 1.0f, 1.0f};
-
-			const auto vertex		= parser::file.vertex(vertIndices.vertex);
-			vertexData.position.x() = vertex.x;
-			vertexData.position.y() = vertex.y;
-			vertexData.position.z() = vertex.z;
-
-			if (vertIndices.texture) {
-				const auto texture = parser::file.texCoord(*vertIndices.texture);
-				vertexData.tex.x() = texture.u;
-				vertexData.tex.y() = 1.0 - texture.v;
-			}
-
-			if (const auto it = index_cache.find(vertexData); it != index_cache.end()) {
-				_indices.push_back(it->second);
-				continue;
-			}
-
-			index_cache[vertexData] = _vertices.size();
-			_indices.push_back(_vertices.size());
-			_vertices.push_back(vertexData);
-		}
-	}
-
-	_vertices.shrink_to_fit();
-	_indices.shrink_to_fit();
+bool VulkanInstance::supports_linear_blit(const VkPhysicalDevice &physical, const VkFormat format) {
+	VkFormatProperties formatProps;
+	vkGetPhysicalDeviceFormatProperties(physical, format, &formatProps);
+	return formatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
 }
 
+
 void VulkanInstance::generate_mip_maps(const VkPhysicalDevice &physical, const VkImage &img, const VkFormat &format, const size_t w, const size_t h,
 									   const uint32_t mipLevels) const {
-	// Check if image format supports linear blitting
-	VkFormatProperties formatProps;
-	vkGetPhysicalDeviceFormatProperties(physical, format, &formatProps);
-	if (!(formatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
+	if (!supports_linear_blit(physical, format)) {
 		throw std::runtime_error("couldn't generate mipmaps for current texture as device doesn't support linear bliting");
 	}
 
@@ -2,10 +2,13 @@
 
 #include "maths/vec.h"
 
+#include <cmath>
+#include <stdexcept>
+
 namespace maths {
 
 // clang-format off
-Mat4 Mat4::identity(
+const Mat4 Mat4::identity(
 		1.0f, 0.0f, 0.0f, 0.0f,
 		0.0f, 1.0f, 0.0f, 0.0f,
 		0.0f, 0.0f, 1.0f, 0.0f,
@@ -96,22 +99,22 @@ Mat4 &Mat4::operator*=(const Mat4 &other) {
 	_repr[0][0] = a11 * b11 + a12 * b21 + a13 * b31 + a14 * b41;
 	_repr[0][1] = a11 * b12 + a12 * b22 + a13 * b32 + a14 * b42;
 	_repr[0][2] = a11 * b13 + a12 * b23 + a13 * b33 + a14 * b43;
-	_repr[0][0] = a11 * b14 + a12 * b24 + a13 * b34 + a14 * b44;
+	_repr[0][3] = a11 * b14 + a12 * b24 + a13 * b34 + a14 * b44;
 
 	_repr[1][0] = a21 * b11 + a22 * b21 + a23 * b31 + a24 * b41;
 	_repr[1][1] = a21 * b12 + a22 * b22 + a23 * b32 + a24 * b42;
 	_repr[1][2] = a21 * b13 + a22 * b23 + a23 * b33 + a24 * b43;
-	_repr[1][0] = a21 * b14 + a22 * b24 + a23 * b34 + a24 * b44;
+	_repr[1][3] = a21 * b14 + a22 * b24 + a23 * b34 + a24 * b44;
 
 	_repr[2][0] = a31 * b11 + a32 * b21 + a33 * b31 + a34 * b41;
 	_repr[2][1] = a31 * b12 + a32 * b22 + a33 * b32 + a34 * b42;
 	_repr[2][2] = a31 * b13 + a32 * b23 + a33 * b33 + a34 * b43;
-	_repr[2][0] = a31 * b14 + a32 * b24 + a33 * b34 + a34 * b44;
+	_repr[2][3] = a31 * b14 + a32 * b24 + a33 * b34 + a34 * b44;
 
 	_repr[3][0] = a41 * b11 + a42 * b21 + a43 * b31 + a44 * b41;
 	_repr[3][1] = a41 * b12 + a42 * b22 + a43 * b32 + a44 * b42;
 	_repr[3][2] = a41 * b13 + a42 * b23 + a43 * b33 + a44 * b43;
-	_repr[3][0] = a41 * b14 + a42 * b24 + a43 * b34 + a44 * b44;
+	_repr[3][3] = a41 * b14 + a42 * b24 + a43 * b34 + a44 * b44;
 
 	return *this;
 }
@@ -168,6 +171,20 @@ Mat4 operator*(const double lambda, const Mat4 &other) {
 	return other * lambda;
 }
 
+Vec3 Mat4::transform_point(const Vec3 &p) const {
+	const auto &m = _repr;
+	return Vec3(m[0][0] * p.x() + m[1][0] * p.y() + m[2][0] * p.z() + m[3][0], m[0][1] * p.x() + m[1][1] * p.y() + m[2][1] * p.z() + m[3][1],
+				m[0][2] * p.x() + m[1][2] * p.y() + m[2][2] * p.z() + m[3][2]);
+}
+
+Mat4 Mat4::translate(const Vec3 &offset) {
+	Mat4 m	= identity;
+	m[3][0] = offset.x();
+	m[3][1] = offset.y();
+	m[3][2] = offset.z();
+	return m;
+}
+
 Mat4 Mat4::rotate(const InternalType angle, const Vec3 &u) {
 	float ux, uy, uz;
 	auto  uNormalized	 = u.normalized();
@@ -1,5 +1,7 @@
 #include "maths/vec.h"
 
+#include <cmath>
+
 namespace maths {
 
 /**************************************************************************************/
@@ -74,7 +76,8 @@ float Vec2::norm() const {
 float Vec2::compute_norm(const bool use_sqrt) const {
 	// .first => Repr used to compute norm
 	// .second => Cached norm in which .first will be the Scalar Product (norm * norm) and .second will be the squared root of .first
-	static std::pair<Repr, NormPair> cachedNorm{
+	// thread_local so that concurrent loaders never race on the cache
+	thread_local std::pair<Repr, NormPair> cachedNorm{
 		{0, 0},
 		{0, 0}
 	  };
@@ -197,7 +200,8 @@ float Vec3::norm() const {
 float Vec3::compute_norm(const bool use_sqrt) const {
 	// .first => Repr used to compute norm
 	// .second => Cached norm in which .first will be the Scalar Product (norm * norm) and .second will be the squared root of .first
-	static std::pair<Repr, NormPair> cachedNorm{
+	// thread_local so that concurrent loaders never race on the cache
+	thread_local std::pair<Repr, NormPair> cachedNorm{
 		{0, 0, 0},
 		   {0, 0}
 	 };
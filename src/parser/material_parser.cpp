@@ -0,0 +1,83 @@
+#include "parser/material.h"
+
+#include "parser/parser.h"
+#include "parser/utils.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+using parser::Color;
+using parser::Material;
+
+
+Color::Color(const float r, const float g, const float b) : r(r), g(g), b(b) {
+}
+
+
+Color::Color(std::vector<std::string> const &args) {
+	// `Kd 0.5` is a valid shorthand for a grey
+	if (args.size() != 1 && args.size() != 3) {
+		throw std::invalid_argument("Color expects 1 or 3 arguments");
+	}
+
+	r = std::stof(args[0]);
+	g = args.size() == 3 ? std::stof(args[1]) : r;
+	b = args.size() == 3 ? std::stof(args[2]) : r;
+}
+
+
+Material::Material(std::string name) : name(std::move(name)) {
+}
+
+
+std::vector<Material> parser::parse_mtl(const std::string &filename) {
+	std::ifstream ifs(filename);
+
+	if (!ifs)
+		throw parser::ifs_error(filename);
+
+	const auto			  directory = std::filesystem::path(filename).parent_path();
+	std::vector<Material> materials;
+
+	auto				  current	= [&]() -> Material & {
+		 if (materials.empty())
+			 throw std::invalid_argument(filename + ": material property found before any newmtl");
+		 return materials.back();
+	};
+
+	std::string line;
+	while (std::getline(ifs, line)) {
+		std::vector<std::string> args;
+		split(args, line);
+		std::erase_if(args, [](const std::string &arg) { return arg.empty() || arg == "\r"; });
+		if (args.empty() || args[0].starts_with('#'))
+			continue;
+
+		std::string id = args[0];
+		args.erase(args.begin());
+
+		if (id == "newmtl")
+			materials.emplace_back(args.empty() ? "" : args[0]);
+		else if (id == "Ka")
+			current().ambient = Color(args);
+		else if (id == "Kd")
+			current().diffuse = Color(args);
+		else if (id == "Ks")
+			current().specular = Color(args);
+		else if (id == "Ns" && !args.empty())
+			current().shininess = std::stof(args[0]);
+		else if (id == "d" && !args.empty())
+			current().dissolve = std::stof(args[0]);
+		else if (id == "Tr" && !args.empty())
+			current().dissolve = 1.0f - std::stof(args[0]);
+		else if (id == "illum" && !args.empty())
+			current().illum = std::stoul(args[0]);
+		else if (id == "map_Kd" && !args.empty())
+			// Options (-s, -o, -bm...) come first, the file name is always the last argument
+			current().diffuse_map = (directory / args.back()).string();
+	}
+
+	return materials;
+}
@@ -2,24 +2,42 @@
 
 #include "parser/utils.h"
 
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 
-parser::File parser::file;
+parser::File parser::parse(const std::string &filename) {
+	File file;
 
-void		 parser::parse(const std::string &filename) {
+	parse(filename, file);
+	return file;
+}
+
+void parser::parse(const std::string &filename, File &file) {
 	std::ifstream ifs(filename);
 
 	if (!ifs)
 		throw parser::ifs_error(filename);
 
 	file.vertices.clear();
+	file.texture_coordinates.clear();
+	file.normals.clear();
+	file.faces.clear();
+	file.material_libraries.clear();
+	file.material_names.clear();
 
-	std::string				 line;
+	const auto						directory = std::filesystem::path(filename).parent_path();
+	std::optional<Face::index_type> material;
+
+	std::string						line;
 	while (std::getline(ifs, line)) {
 		std::vector<std::string> args;
 		split(args, line);
+		if (args.empty())
+			continue;
+
 		std::string id = args[0];
 		args.erase(args.begin());
 
@@ -30,7 +48,17 @@ void		 parser::parse(const std::string &filename) {
 		else if (id == "vn")
 			file.normals.emplace_back(args);
 		else if (id == "f")
-			file.faces.emplace_back(args);
+			file.faces.emplace_back(args).material = material;
+		else if (id == "mtllib") {
+			for (const auto &lib : args)
+				file.material_libraries.push_back((directory / lib).string());
+		} else if (id == "usemtl" && !args.empty()) {
+			const auto it = std::ranges::find(file.material_names, args[0]);
+
+			material	  = static_cast<Face::index_type>(it - file.material_names.begin());
+			if (it == file.material_names.end())
+				file.material_names.push_back(args[0]);
+		}
 	}
 	ifs.close();
 
@@ -59,8 +87,9 @@ void parser::File::triangulate() {
 		 std::cout << std::flush;
 	};
 
-	auto triangle = [](const Face::Indices &a, const Face::Indices &b, const Face::Indices &c) {
+	auto triangle = [](const Face &face, const Face::Indices &a, const Face::Indices &b, const Face::Indices &c) {
 		Face triangleFace{};
+		triangleFace.material = face.material;
 
 		triangleFace.vertices.push_back(b);
 		triangleFace.vertices.push_back(c);
@@ -69,7 +98,9 @@ void parser::File::triangulate() {
 		return triangleFace;
 	};
 
-	printFace("Faces before triangulation:", faces);
+	if constexpr (DEBUG) {
+		printFace("Faces before triangulation:", faces);
+	}
 
 	triangulated.reserve(faces.size() * 2);
 	for (const auto &face : faces) {
@@ -100,8 +131,8 @@ void parser::File::triangulate() {
 
 		auto v = face.vertices;
 
-		triangulated.emplace_back(triangle(v[0], v[1], v[3]));
-		triangulated.emplace_back(triangle(v[3], v[1], v[2]));
+		triangulated.emplace_back(triangle(face, v[0], v[1], v[3]));
+		triangulated.emplace_back(triangle(face, v[3], v[1], v[2]));
 	}
 
 	triangulated.shrink_to_fit();
@@ -0,0 +1,106 @@
+#include "assets/block_compression.h"
+#include "assets/ktx2.h"
+#include "assets/mipmaps.h"
+#include "assets/thread_pool.h"
+#include "graphics/textures.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Offline texture converter: decodes PNG/JPG files, builds their mip chain and writes it block compressed to a
+// `.ktx2` file next to the source, which the loader then picks up instead of decoding the original.
+
+namespace {
+
+using graphics::resources::Texture;
+
+void usage() {
+	std::cerr << "usage: ./scop_texconv [--format bc1|bc7] [--mip-filter box|kaiser] <image>...\n"
+				 "  --format      bc7 (default) keeps alpha and quality, bc1 halves the size again for opaque textures\n"
+				 "  --mip-filter  kaiser (default) keeps distant mips sharper, box is faster"
+			  << std::endl;
+}
+
+double mebibytes(const size_t bytes) {
+	return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+int main(int ac, char **av) {
+	Texture::Format			 format	   = Texture::Format::BC7_SRGB;
+	assets::MipFilter		 mipFilter = assets::MipFilter::Kaiser;
+	std::vector<std::string> inputs;
+
+	for (int i = 1; i < ac; i++) {
+		const std::string arg = av[i];
+
+		if (arg == "--format" && i + 1 < ac) {
+			const std::string value = av[++i];
+			if (value == "bc1") {
+				format = Texture::Format::BC1_RGBA_SRGB;
+			} else if (value == "bc7") {
+				format = Texture::Format::BC7_SRGB;
+			} else {
+				usage();
+				return 1;
+			}
+		} else if (arg == "--mip-filter" && i + 1 < ac) {
+			const std::string value = av[++i];
+			if (value == "box") {
+				mipFilter = assets::MipFilter::Box;
+			} else if (value == "kaiser") {
+				mipFilter = assets::MipFilter::Kaiser;
+			} else {
+				usage();
+				return 1;
+			}
+		} else if (arg.starts_with("-")) {
+			usage();
+			return 1;
+		} else {
+			inputs.push_back(arg);
+		}
+	}
+
+	if (inputs.empty()) {
+		usage();
+		return 1;
+	}
+
+	assets::ThreadPool pool;
+	int				   status = 0;
+
+	for (const auto &input : inputs) {
+		const auto start   = std::chrono::steady_clock::now();
+		const auto decoded = Texture::load(input);
+		if (!decoded) {
+			std::cerr << input << ": couldn't decode image" << std::endl;
+			status = 1;
+			continue;
+		}
+
+		const auto source	 = assets::generate_mips(decoded, mipFilter, &pool);
+		const auto encoded	 = assets::bc::compress(source, format, &pool);
+		const auto output	 = std::filesystem::path(input).replace_extension(".ktx2");
+
+		try {
+			assets::ktx2::write(output.string(), encoded);
+		} catch (const std::exception &e) {
+			std::cerr << e.what() << std::endl;
+			status = 1;
+			continue;
+		}
+
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		std::cout << std::fixed << std::setprecision(2) << input << " -> " << output.string() << ": " << encoded.w << "x" << encoded.h << ", "
+				  << encoded.levels << " levels, " << mebibytes(source.device_size()) << " MiB -> " << mebibytes(encoded.device_size()) << " MiB in "
+				  << elapsed.count() << " ms" << std::endl;
+	}
+
+	return status;
+}